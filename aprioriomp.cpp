@@ -1,222 +1,2067 @@
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_BITMAP_KERNELS 1
+#endif
 
 using namespace std;
 using namespace std::chrono;
 
+// Sampling mode: chance that a given frequent itemset falls below the lowered
+// threshold in the sample, and the seed that makes the sample reproducible
+const double SAMPLE_MISS_PROBABILITY = 0.01;
+const unsigned SAMPLE_SEED = 12345;
+
+// Itemset widths with specialized join, subset test and hashing; wider levels use the
+// generic code, written as the W = 0 instantiation that reads the width at run time
+const size_t MAX_FIXED_WIDTH = 8;
+
+// Compare two itemsets of W items, or of `width` items when W is 0. With W known at
+// compile time the loop unrolls and the comparison has no branches.
+template <size_t W>
+static inline bool sameItems(const uint32_t* a, const uint32_t* b, size_t width) {
+    uint32_t difference = 0;
+    for (size_t i = 0; i < (W ? W : width); i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+// FNV-1a hash over the item IDs of an itemset
+struct ItemsetHash {
+    // W items, or `width` items when W is 0
+    template <size_t W>
+    size_t hashItems(const uint32_t* items, size_t width) const {
+        size_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < (W ? W : width); i++) {
+            hash ^= items[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+    
+    size_t operator()(const uint32_t* items, size_t width) const {
+        return hashItems<0>(items, width);
+    }
+    
+    size_t operator()(const vector<uint32_t>& itemset) const {
+        return hashItems<0>(itemset.data(), itemset.size());
+    }
+};
+
+// All itemsets of one size with their counts. The item IDs of every itemset sit back
+// to back in one array, which serves as the level's arena: a level is moved from stage
+// to stage and its memory is released in one step. Lookups go through an
+// open-addressing hash index that is built on demand.
+class ItemsetStore {
+private:
+    size_t width;            // Items per itemset
+    vector<uint32_t> items;  // `width` item IDs per itemset
+    vector<int> counts;
+    vector<uint32_t> slots;  // Hash index: itemset position + 1, or 0 for an empty slot
+    
+public:
+    explicit ItemsetStore(size_t itemset_width = 0) : width(itemset_width) {}
+    
+    size_t size() const { return counts.size(); }
+    bool empty() const { return counts.empty(); }
+    size_t itemsetWidth() const { return width; }
+    const uint32_t* itemset(size_t i) const { return items.data() + i * width; }
+    int count(size_t i) const { return counts[i]; }
+    int* countData() { return counts.data(); }
+    
+    void reserve(size_t itemset_count) {
+        items.reserve(itemset_count * width);
+        counts.reserve(itemset_count);
+    }
+    
+    void append(const uint32_t* itemset, int count) {
+        items.insert(items.end(), itemset, itemset + width);
+        counts.push_back(count);
+    }
+    
+    // Append the itemsets of another store of the same width
+    void appendAll(const ItemsetStore& other) {
+        items.insert(items.end(), other.items.begin(), other.items.end());
+        counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+    }
+    
+    // Keep the itemsets counted at least min_count times, compacting in place
+    void retainAtLeast(int min_count) {
+        size_t kept = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] < min_count) continue;
+            if (kept != i) {
+                copy(items.begin() + i * width, items.begin() + (i + 1) * width, items.begin() + kept * width);
+                counts[kept] = counts[i];
+            }
+            kept++;
+        }
+        items.resize(kept * width);
+        counts.resize(kept);
+        slots.clear();
+    }
+    
+    // Put the itemsets in lexicographic order
+    void sortItemsets() {
+        vector<uint32_t> order(size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return lexicographical_compare(itemset(a), itemset(a) + width, itemset(b), itemset(b) + width);
+        });
+        
+        ItemsetStore sorted(width);
+        sorted.reserve(size());
+        for (uint32_t i : order) {
+            sorted.append(itemset(i), counts[i]);
+        }
+        swap(sorted);
+    }
+    
+    // Index every itemset in a table of at least twice as many slots, probed linearly
+    void buildIndex() {
+        size_t capacity = 16;
+        while (capacity < 2 * size()) capacity *= 2;
+        slots.assign(capacity, 0);
+        
+        ItemsetHash hasher;
+        for (size_t i = 0; i < size(); i++) {
+            size_t slot = hasher(itemset(i), width) & (capacity - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = i + 1;
+        }
+    }
+    
+    // Position of an itemset of this width, or -1; needs buildIndex(). W, when not 0,
+    // must equal the width and lets hashing and comparison unroll.
+    template <size_t W = 0>
+    long long find(const uint32_t* wanted) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = ItemsetHash().hashItems<W>(wanted, width) & mask;
+        while (slots[slot] != 0) {
+            size_t i = slots[slot] - 1;
+            if (sameItems<W>(wanted, itemset(i), width)) return i;
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+    
+    void swap(ItemsetStore& other) {
+        std::swap(width, other.width);
+        items.swap(other.items);
+        counts.swap(other.counts);
+        slots.swap(other.slots);
+    }
+    
+    // Conversions for the stages that still keep itemsets of mixed sizes in a map
+    static ItemsetStore fromMap(const map<vector<uint32_t>, int>& itemsets) {
+        ItemsetStore store(itemsets.empty() ? 0 : itemsets.begin()->first.size());
+        store.reserve(itemsets.size());
+        for (const auto& pair : itemsets) {
+            store.append(pair.first.data(), pair.second);
+        }
+        return store;
+    }
+    
+    void addTo(map<vector<uint32_t>, int>& itemsets) const {
+        for (size_t i = 0; i < size(); i++) {
+            itemsets.emplace_hint(itemsets.end(), vector<uint32_t>(itemset(i), itemset(i) + width), counts[i]);
+        }
+    }
+};
+
+// Header of the binary transaction database written by convert. The header is
+// followed by the item dictionary and the distinct transactions in CSR form,
+// with every section starting on an 8-byte boundary.
+struct BinaryDatabaseHeader {
+    char magic[8];                // "APRIODB1"
+    uint64_t item_count;
+    uint64_t transaction_count;   // Distinct transactions
+    uint64_t total_transactions;  // Transactions in the source file, duplicates included
+    uint64_t item_entries;        // Length of the items section
+    uint64_t names_bytes;
+};
+
+// Byte offsets of the sections that follow the header
+struct BinaryDatabaseLayout {
+    uint64_t name_offsets;  // uint64_t[item_count + 1] into names
+    uint64_t names;         // char[names_bytes], item names in ID order
+    uint64_t offsets;       // uint64_t[transaction_count + 1] into items
+    uint64_t weights;       // uint32_t[transaction_count]
+    uint64_t items;         // uint32_t[item_entries], sorted item IDs per transaction
+    uint64_t file_size;
+    
+    BinaryDatabaseLayout(const BinaryDatabaseHeader& header) {
+        name_offsets = align(sizeof(BinaryDatabaseHeader));
+        names = align(name_offsets + (header.item_count + 1) * sizeof(uint64_t));
+        offsets = align(names + header.names_bytes);
+        weights = align(offsets + (header.transaction_count + 1) * sizeof(uint64_t));
+        items = align(weights + header.transaction_count * sizeof(uint32_t));
+        file_size = items + header.item_entries * sizeof(uint32_t);
+    }
+    
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+};
+
+// Level-2 pairs are counted in a triangular matrix while it has at most this many entries
+const size_t MAX_PAIR_MATRIX_ENTRIES = size_t(1) << 24;
+
+// Subset kernels over item bitmaps: add the weight to counts[c] for every candidate
+// bitmap contained in the transaction bitmap. Candidates are stored back to back,
+// `words` 64-bit words each.
+typedef void (*BitmapKernel)(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts);
+
+static void countBitmapsScalar(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * words;
+        uint64_t missing = 0;
+        for (size_t w = 0; w < words; w++) {
+            missing |= candidate[w] & ~transaction[w];
+        }
+        if (missing == 0) counts[c] += weight;
+    }
+}
+
+#ifdef HAVE_X86_BITMAP_KERNELS
+// testc is set when no candidate bit is missing from the transaction
+__attribute__((target("avx2")))
+static void countBitmapsAVX2(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts) {
+    __m256i low = _mm256_loadu_si256((const __m256i*)transaction);
+    if (words == 4) {
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m256i candidate = _mm256_loadu_si256((const __m256i*)(candidates + c * 4));
+            if (_mm256_testc_si256(low, candidate)) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m256i high = _mm256_loadu_si256((const __m256i*)(transaction + 4));
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * 8;
+        if (_mm256_testc_si256(low, _mm256_loadu_si256((const __m256i*)candidate)) &
+            _mm256_testc_si256(high, _mm256_loadu_si256((const __m256i*)(candidate + 4)))) {
+            counts[c] += weight;
+        }
+    }
+}
+
+// 512-bit universes test one candidate per instruction, 256-bit universes two
+__attribute__((target("avx512f")))
+static void countBitmapsAVX512(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    if (words == 8) {
+        __m512i bits = _mm512_loadu_si512(transaction);
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 8));
+            if (_mm512_test_epi64_mask(missing, missing) == 0) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m512i bits = _mm512_broadcast_i64x4(_mm256_loadu_si256((const __m256i*)transaction));
+    size_t c = 0;
+    for (; c + 2 <= candidate_count; c += 2) {
+        __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 4));
+        __mmask8 mask = _mm512_test_epi64_mask(missing, missing);
+        if ((mask & 0x0F) == 0) counts[c] += weight;
+        if ((mask & 0xF0) == 0) counts[c + 1] += weight;
+    }
+    countBitmapsScalar(candidates + c * 4, candidate_count - c, 4, transaction, weight, counts + c);
+}
+#endif
+
+// Pick the widest kernel the running CPU supports
+static BitmapKernel selectBitmapKernel() {
+#ifdef HAVE_X86_BITMAP_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return countBitmapsAVX512;
+    if (__builtin_cpu_supports("avx2")) return countBitmapsAVX2;
+#endif
+    return countBitmapsScalar;
+}
+
+// Candidates of one level as fixed-width item bitmaps, usable when there are at most
+// 1024 candidates spanning at most 512 distinct items. Each transaction is turned into
+// a bitmap once and tested against every candidate with a few vector instructions.
+class BitmapCounter {
+private:
+    vector<int> item_bit;             // Bit of each item, -1 if no candidate uses it
+    vector<uint64_t> candidate_bits;  // `words` words per candidate, back to back
+    size_t candidate_count;
+    size_t words;                     // 4 (256 bits) or 8 (512 bits); 0 if the bitmaps are not used
+    size_t depth;
+    BitmapKernel kernel;
+    
+public:
+    BitmapCounter(const ItemsetStore& candidates, size_t item_count)
+        : item_bit(item_count, -1), candidate_count(candidates.size()), words(0),
+          depth(candidates.itemsetWidth()), kernel(selectBitmapKernel()) {
+        int universe = 0;
+        for (size_t c = 0; c < candidate_count; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                uint32_t item = candidates.itemset(c)[i];
+                if (item_bit[item] < 0) item_bit[item] = universe++;
+            }
+        }
+        // Every transaction is tested against every candidate, so beyond about a thousand
+        // candidates the trie, which only visits candidates sharing a prefix, is faster
+        if (universe > 512 || candidate_count > 1024) return;
+        
+        words = universe <= 256 ? 4 : 8;
+        candidate_bits.assign(candidate_count * words, 0);
+        for (size_t c = 0; c < candidate_count; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                int bit = item_bit[candidates.itemset(c)[i]];
+                candidate_bits[c * words + bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+    }
+    
+    bool usable() const {
+        return words != 0;
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (candidate_count == 0 || transaction.size() < depth) return;
+        
+        uint64_t bits[8] = {0};
+        size_t present = 0;
+        for (uint32_t item : transaction) {
+            int bit = item_bit[item];
+            if (bit < 0) continue;
+            bits[bit / 64] |= uint64_t(1) << (bit % 64);
+            present++;
+        }
+        
+        if (present >= depth) {
+            kernel(candidate_bits.data(), candidate_count, words, bits, weight, counts.data());
+        }
+    }
+};
+
+// Prefix trie over the candidates of one level. Each transaction walks the
+// trie once and increments only the candidates it contains.
+class CandidateTrie {
+private:
+    struct Node {
+        vector<uint32_t> items;  // Sorted child items
+        vector<int> children;    // Child node index, or candidate index at the last level
+    };
+    
+    vector<Node> nodes;
+    size_t depth;
+    
+    void countNode(int node, const vector<uint32_t>& transaction, size_t start,
+                   size_t level, int weight, vector<int>& counts) const {
+        const Node& current = nodes[node];
+        size_t remaining = depth - level - 1;
+        size_t last = transaction.size() - remaining;
+        size_t child = 0;
+        
+        for (size_t t = start; t < last; t++) {
+            auto it = lower_bound(current.items.begin() + child, current.items.end(), transaction[t]);
+            if (it == current.items.end()) break;
+            
+            child = it - current.items.begin();
+            if (*it == transaction[t]) {
+                if (remaining == 0) {
+                    counts[current.children[child]] += weight;
+                } else {
+                    countNode(current.children[child], transaction, t + 1, level + 1, weight, counts);
+                }
+                child++;
+            }
+        }
+    }
+    
+public:
+    // Candidates must be in sorted order
+    CandidateTrie(const ItemsetStore& candidates)
+        : nodes(1), depth(candidates.empty() ? 0 : candidates.itemsetWidth()) {
+        for (size_t c = 0; c < candidates.size(); c++) {
+            int node = 0;
+            for (size_t level = 0; level < depth; level++) {
+                uint32_t item = candidates.itemset(c)[level];
+                bool leaf = (level + 1 == depth);
+                
+                // Sorted insertion means a shared prefix is always the last child
+                if (nodes[node].items.empty() || nodes[node].items.back() != item) {
+                    int target = leaf ? (int)c : (int)nodes.size();
+                    nodes[node].items.push_back(item);
+                    nodes[node].children.push_back(target);
+                    if (!leaf) nodes.push_back(Node());
+                }
+                node = nodes[node].children.back();
+            }
+        }
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (depth == 0 || transaction.size() < depth) return;
+        countNode(0, transaction, 0, 0, weight, counts);
+    }
+};
+
+// FP-tree: transactions are inserted with their items in a fixed header order,
+// so transactions sharing a prefix share a path of counted nodes
+class FPTree {
+private:
+    struct Node {
+        uint32_t item;
+        int count;
+        int parent;
+        int first_child;
+        int next_sibling;
+        int next_same_item;  // Next node in the header chain of this item
+    };
+    
+    struct HeaderEntry {
+        uint32_t item;
+        int support;
+        int first_node;
+    };
+    
+    vector<Node> nodes;                   // Node 0 is the root
+    vector<HeaderEntry> header;           // Frequent items in tree order
+    unordered_map<uint32_t, int> header_index;
+    int min_support;
+    
+public:
+    FPTree(int min_sup) : min_support(min_sup) {
+        Node root = {0, 0, -1, -1, -1, -1};
+        nodes.push_back(root);
+    }
+    
+    // Fix the tree order; items missing from ordered_items are dropped on insert
+    void setHeader(const vector<pair<uint32_t, int>>& ordered_items) {
+        header.clear();
+        header_index.clear();
+        for (const auto& pair : ordered_items) {
+            header_index[pair.first] = header.size();
+            HeaderEntry entry = {pair.first, pair.second, -1};
+            header.push_back(entry);
+        }
+    }
+    
+    // Order (item, support) pairs by descending support, breaking ties by item ID
+    static void sortBySupport(vector<pair<uint32_t, int>>& items) {
+        sort(items.begin(), items.end(), [](const pair<uint32_t, int>& a, const pair<uint32_t, int>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+    
+    // Insert a transaction with the given multiplicity
+    void insert(const vector<uint32_t>& transaction, int count) {
+        vector<int> path;
+        for (uint32_t item : transaction) {
+            auto it = header_index.find(item);
+            if (it != header_index.end()) {
+                path.push_back(it->second);
+            }
+        }
+        sort(path.begin(), path.end());
+        
+        int node = 0;
+        for (int h : path) {
+            int child = nodes[node].first_child;
+            while (child != -1 && nodes[child].item != header[h].item) {
+                child = nodes[child].next_sibling;
+            }
+            
+            if (child == -1) {
+                child = nodes.size();
+                Node created = {header[h].item, 0, node, -1, nodes[node].first_child, header[h].first_node};
+                nodes.push_back(created);
+                nodes[node].first_child = child;
+                header[h].first_node = child;
+            }
+            
+            nodes[child].count += count;
+            node = child;
+        }
+    }
+    
+    size_t headerSize() const {
+        return header.size();
+    }
+    
+    uint32_t headerItem(size_t h) const {
+        return header[h].item;
+    }
+    
+    // Mine every frequent itemset that ends with header item h, extended by suffix
+    void mineItem(size_t h, vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        suffix.push_back(header[h].item);
+        vector<uint32_t> itemset = suffix;
+        sort(itemset.begin(), itemset.end());
+        results[itemset] = header[h].support;
+        
+        // Conditional pattern base: the path above every node of this item
+        vector<pair<vector<uint32_t>, int>> pattern_base;
+        unordered_map<uint32_t, int> conditional_counts;
+        for (int n = header[h].first_node; n != -1; n = nodes[n].next_same_item) {
+            vector<uint32_t> path;
+            for (int p = nodes[n].parent; p != 0; p = nodes[p].parent) {
+                path.push_back(nodes[p].item);
+                conditional_counts[nodes[p].item] += nodes[n].count;
+            }
+            if (!path.empty()) {
+                pattern_base.push_back(make_pair(path, nodes[n].count));
+            }
+        }
+        
+        vector<pair<uint32_t, int>> conditional_items;
+        for (const auto& pair : conditional_counts) {
+            if (pair.second >= min_support) {
+                conditional_items.push_back(pair);
+            }
+        }
+        
+        if (!conditional_items.empty()) {
+            sortBySupport(conditional_items);
+            FPTree conditional(min_support);
+            conditional.setHeader(conditional_items);
+            for (const auto& pattern : pattern_base) {
+                conditional.insert(pattern.first, pattern.second);
+            }
+            conditional.mine(suffix, results);
+        }
+        
+        suffix.pop_back();
+    }
+    
+    // Mine the whole tree, least frequent header items first
+    void mine(vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        for (size_t h = header.size(); h-- > 0;) {
+            mineItem(h, suffix, results);
+        }
+    }
+};
+
+// Member of an Eclat prefix class: the extending item and the bitset of
+// transactions containing prefix + item
+struct EclatMember {
+    uint32_t item;
+    int support;
+    vector<uint64_t> tids;
+};
+
+// Member of a CHARM class: the items it adds to the class prefix, which grow when
+// joins show they always occur together, and the bitset of their transactions
+struct ClosedMember {
+    vector<uint32_t> items;
+    int support;
+    vector<uint64_t> tids;
+};
+
+// Counts kept by a previous incremental run, by item name
+struct IncrementalState {
+    long long transactions;                      // Transactions covered by the state
+    uint64_t bytes;                              // Length of the file prefix holding them
+    vector<pair<vector<string>, int>> itemsets;  // Frequent itemsets and their negative border
+};
+
 class SequentialApriori {
 private:
     int min_support;
-    vector<vector<string>> transactions;
+    vector<vector<uint32_t>> transactions;  // Distinct transactions
+    vector<int> transaction_weights;        // Multiplicity of each distinct transaction
+    int total_transactions;                 // Transactions in the file, duplicates included
+    bool unit_weights;                      // True when no transaction was collapsed
+    vector<string> item_names;              // Item dictionary: item ID -> item name
     
 public:
-    SequentialApriori(int min_sup) : min_support(min_sup) {}
+    SequentialApriori(int min_sup) : min_support(min_sup), total_transactions(0), unit_weights(true) {}
+    
+    // Read transactions from file, encoding every item as an integer ID
+    bool loadTransactions(const string& filename) {
+        if (isBinaryDatabase(filename)) {
+            return loadBinaryDatabase(filename);
+        }
+        
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            return false;
+        }
+        
+        string line;
+        transactions.clear();
+        unordered_map<string, uint32_t> item_ids;
+        
+        vector<uint32_t> transaction;
+        while (getline(file, line)) {
+            if (parseTransaction(line, item_ids, transaction)) {
+                transactions.push_back(transaction);
+            }
+        }
+        
+        file.close();
+        total_transactions = transactions.size();
+        buildItemDictionary(item_ids);
+        collapseDuplicateTransactions();
+        cout << "Loaded " << total_transactions << " transactions ("
+             << transactions.size() << " distinct)" << endl;
+        return true;
+    }
+    
+    // Encode one line as item IDs, adding unseen items to item_ids. Items are comma
+    // separated and trimmed, and empty items and the -1 sentinel are skipped.
+    bool parseTransaction(const string& line, unordered_map<string, uint32_t>& item_ids,
+                          vector<uint32_t>& transaction) {
+        transaction.clear();
+        if (line.empty()) return false;
+        
+        stringstream ss(line);
+        string item;
+        while (getline(ss, item, ',')) {
+            // Trim whitespace
+            item.erase(0, item.find_first_not_of(" \t"));
+            item.erase(item.find_last_not_of(" \t") + 1);
+            
+            if (!item.empty() && item != "-1") {
+                auto inserted = item_ids.insert(make_pair(item, (uint32_t)item_ids.size()));
+                transaction.push_back(inserted.first->second);
+            }
+        }
+        
+        return !transaction.empty();
+    }
+    
+    // Check whether the file starts with the binary database magic
+    bool isBinaryDatabase(const string& filename) {
+        ifstream file(filename, ios::binary);
+        char magic[8] = {0};
+        file.read(magic, sizeof(magic));
+        return file.gcount() == sizeof(magic) && memcmp(magic, "APRIODB1", sizeof(magic)) == 0;
+    }
+    
+    // Load a binary database written by convert; the file is mapped and the
+    // already encoded, deduplicated transactions are copied out without parsing
+    bool loadBinaryDatabase(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd < 0 || fstat(fd, &file_stat) != 0) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        
+        size_t file_size = file_stat.st_size;
+        void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            cerr << "Error: Cannot map file " << filename << endl;
+            return false;
+        }
+        
+        const char* data = (const char*)mapped;
+        const BinaryDatabaseHeader* header = (const BinaryDatabaseHeader*)data;
+        BinaryDatabaseLayout layout(*header);
+        if (file_size < layout.file_size) {
+            cerr << "Error: Binary database " << filename << " is truncated" << endl;
+            munmap(mapped, file_size);
+            return false;
+        }
+        
+        const uint64_t* name_offsets = (const uint64_t*)(data + layout.name_offsets);
+        const char* names = data + layout.names;
+        item_names.resize(header->item_count);
+        for (size_t i = 0; i < item_names.size(); i++) {
+            item_names[i].assign(names + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+        }
+        
+        const uint64_t* offsets = (const uint64_t*)(data + layout.offsets);
+        const uint32_t* weights = (const uint32_t*)(data + layout.weights);
+        const uint32_t* items = (const uint32_t*)(data + layout.items);
+        transactions.resize(header->transaction_count);
+        transaction_weights.assign(weights, weights + header->transaction_count);
+        for (size_t t = 0; t < transactions.size(); t++) {
+            transactions[t].assign(items + offsets[t], items + offsets[t + 1]);
+        }
+        
+        total_transactions = header->total_transactions;
+        unit_weights = (transactions.size() == (size_t)total_transactions);
+        munmap(mapped, file_size);
+        
+        cout << "Loaded " << total_transactions << " transactions ("
+             << transactions.size() << " distinct) from binary database" << endl;
+        return true;
+    }
+    
+    // Renumber item IDs in name order so integer itemsets sort like string itemsets
+    void buildItemDictionary(const unordered_map<string, uint32_t>& item_ids) {
+        vector<string> names(item_ids.size());
+        for (const auto& pair : item_ids) {
+            names[pair.second] = pair.first;
+        }
+        
+        vector<uint32_t> order(names.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return names[a] < names[b];
+        });
+        
+        vector<uint32_t> new_ids(names.size());
+        item_names.resize(names.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            new_ids[order[i]] = i;
+            item_names[i] = names[order[i]];
+        }
+        
+        // Rewrite transactions as sorted sets of the final IDs
+        for (auto& transaction : transactions) {
+            for (uint32_t& item : transaction) {
+                item = new_ids[item];
+            }
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        }
+    }
+    
+    // Collapse identical sorted transactions into one transaction with a multiplicity
+    void collapseDuplicateTransactions() {
+        collapseDuplicates(transactions, transaction_weights);
+        unit_weights = (transactions.size() == (size_t)total_transactions);
+    }
+    
+    // Generate frequent 1-itemsets
+    ItemsetStore generateFrequent1Itemsets() {
+        vector<int> item_counts(item_names.size(), 0);
+        
+        // Count individual items
+        for (size_t t = 0; t < transactions.size(); t++) {
+            for (uint32_t item : transactions[t]) {
+                item_counts[item] += transaction_weights[t];
+            }
+        }
+        
+        // Filter by minimum support; item IDs come out in sorted order
+        ItemsetStore frequent_1_itemsets(1);
+        for (uint32_t item = 0; item < item_counts.size(); item++) {
+            if (item_counts[item] >= min_support) {
+                frequent_1_itemsets.append(&item, item_counts[item]);
+            }
+        }
+        
+        return frequent_1_itemsets;
+    }
+    
+    // Generate candidate itemsets from frequent k-itemsets (Apriori-gen), with the
+    // candidate width fixed at compile time for the common small levels
+    ItemsetStore generateCandidates(ItemsetStore& frequent_k) {
+        static_assert(MAX_FIXED_WIDTH == 8, "the cases below must cover widths 2 to MAX_FIXED_WIDTH");
+        frequent_k.buildIndex();
+        
+        switch (frequent_k.itemsetWidth() + 1) {
+            case 2: return joinLevel<2>(frequent_k);
+            case 3: return joinLevel<3>(frequent_k);
+            case 4: return joinLevel<4>(frequent_k);
+            case 5: return joinLevel<5>(frequent_k);
+            case 6: return joinLevel<6>(frequent_k);
+            case 7: return joinLevel<7>(frequent_k);
+            case 8: return joinLevel<8>(frequent_k);
+            default: return joinLevel<0>(frequent_k);
+        }
+    }
+    
+    // Join the indexed frequent itemsets into candidates of K items, or of any width
+    // when K is 0. The frequent itemsets are sorted, so itemsets sharing their first
+    // k-1 items form contiguous prefix classes, and only pairs within a class are joined.
+    template <size_t K>
+    ItemsetStore joinLevel(const ItemsetStore& frequent_k) {
+        size_t k = K ? K - 1 : frequent_k.itemsetWidth();
+        ItemsetStore candidates(k + 1);
+        
+        array<uint32_t, MAX_FIXED_WIDTH> fixed_candidate;
+        array<uint32_t, MAX_FIXED_WIDTH> fixed_subset;
+        vector<uint32_t> wide_candidate(K ? 0 : k + 1);
+        vector<uint32_t> wide_subset(K ? 0 : k);
+        uint32_t* candidate = K ? fixed_candidate.data() : wide_candidate.data();
+        uint32_t* subset = K ? fixed_subset.data() : wide_subset.data();
+        
+        size_t class_start = 0;
+        while (class_start < frequent_k.size()) {
+            size_t class_end = prefixClassEnd<K>(frequent_k, class_start);
+            
+            for (size_t i = class_start; i < class_end; i++) {
+                copy(frequent_k.itemset(i), frequent_k.itemset(i) + (K ? K - 1 : k), candidate);
+                for (size_t j = i + 1; j < class_end; j++) {
+                    candidate[k] = frequent_k.itemset(j)[k - 1];
+                    
+                    if (hasFrequentSubsets<K>(candidate, k + 1, frequent_k, subset)) {
+                        candidates.append(candidate, 0);
+                    }
+                }
+            }
+            
+            class_start = class_end;
+        }
+        
+        return candidates;
+    }
+    
+    // Apriori-gen for the stages that keep a level in a map
+    map<vector<uint32_t>, int> generateCandidates(const map<vector<uint32_t>, int>& frequent_k) {
+        ItemsetStore frequent = ItemsetStore::fromMap(frequent_k);
+        map<vector<uint32_t>, int> candidates;
+        generateCandidates(frequent).addTo(candidates);
+        return candidates;
+    }
+    
+    // Find the end of the prefix class that starts at itemset `start`, for joins
+    // into candidates of K items (any width when K is 0)
+    template <size_t K>
+    size_t prefixClassEnd(const ItemsetStore& itemsets, size_t start) {
+        size_t prefix = itemsets.itemsetWidth() - 1;
+        size_t end = start + 1;
+        while (end < itemsets.size() &&
+               sameItems<K ? K - 2 : 0>(itemsets.itemset(start), itemsets.itemset(end), prefix)) {
+            end++;
+        }
+        return end;
+    }
+    
+    // Check that every k-subset of a (k+1)-candidate of `width` items is frequent
+    // (downward closure), using `subset` as scratch space for k items. The subsets
+    // dropping either of the last two items are the joined itemsets themselves.
+    template <size_t K>
+    bool hasFrequentSubsets(const uint32_t* candidate, size_t width, const ItemsetStore& frequent_k,
+                            uint32_t* subset) {
+        size_t n = K ? K : width;
+        if (n <= 2) return true;
+        
+        for (size_t i = 1; i < n; i++) {
+            subset[i - 1] = candidate[i];
+        }
+        for (size_t skip = 0; skip + 2 < n; skip++) {
+            if (skip > 0) subset[skip - 1] = candidate[skip - 1];
+            if (frequent_k.find<K ? K - 1 : 0>(subset) < 0) {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    // Count support for candidates in place, using a prefix trie built once for this level
+    void countSupport(ItemsetStore& candidates, const vector<vector<uint32_t>>& database,
+                      const vector<int>& weights) {
+        // Candidates over a small item universe are tested as bitmaps, others walk the trie
+        BitmapCounter bitmap(candidates, item_names.size());
+        CandidateTrie trie(bitmap.usable() ? ItemsetStore() : candidates);
+        vector<int> counts(candidates.size(), 0);
+        
+        for (size_t t = 0; t < database.size(); t++) {
+            if (bitmap.usable()) {
+                bitmap.count(database[t], weights[t], counts);
+            } else {
+                trie.count(database[t], weights[t], counts);
+            }
+        }
+        
+        copy(counts.begin(), counts.end(), candidates.countData());
+    }
+    
+    // Support counting for the stages that keep a level in a map
+    map<vector<uint32_t>, int> countSupport(const map<vector<uint32_t>, int>& candidates,
+                                            const vector<vector<uint32_t>>& database,
+                                            const vector<int>& weights) {
+        ItemsetStore store = ItemsetStore::fromMap(candidates);
+        countSupport(store, database, weights);
+        
+        map<vector<uint32_t>, int> support_counts;
+        store.addTo(support_counts);
+        return support_counts;
+    }
+    
+    // Count every pair of frequent items in one pass, into a flat upper-triangular
+    // matrix indexed by item rank, and return the frequent 2-itemsets
+    ItemsetStore countFrequentPairs(const ItemsetStore& frequent_1, const vector<vector<uint32_t>>& database,
+                                    const vector<int>& weights) {
+        vector<uint32_t> items;
+        vector<int> item_rank(item_names.size(), -1);
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            item_rank[frequent_1.itemset(i)[0]] = items.size();
+            items.push_back(frequent_1.itemset(i)[0]);
+        }
+        size_t n = items.size();
+        
+        vector<uint32_t> matrix(n * (n - 1) / 2, 0);
+        vector<uint32_t> ranks;
+        for (size_t t = 0; t < database.size(); t++) {
+            ranks.clear();
+            for (uint32_t item : database[t]) {
+                if (item_rank[item] >= 0) ranks.push_back(item_rank[item]);
+            }
+            for (size_t a = 0; a < ranks.size(); a++) {
+                size_t r = ranks[a];
+                size_t row = pairRowStart(r, n);
+                for (size_t b = a + 1; b < ranks.size(); b++) {
+                    matrix[row + (ranks[b] - r - 1)] += weights[t];
+                }
+            }
+        }
+        
+        return readFrequentPairs(items, matrix);
+    }
+    
+    // Level 2 uses the pair matrix when there are pairs to count and the matrix is small enough
+    bool pairMatrixFits(size_t frequent_items) {
+        return frequent_items >= 2 && frequent_items * (frequent_items - 1) / 2 <= MAX_PAIR_MATRIX_ENTRIES;
+    }
+    
+    // Offset of row r in the flat upper-triangular matrix over n items; pair (r, c)
+    // with r < c lives at pairRowStart(r, n) + (c - r - 1)
+    size_t pairRowStart(size_t r, size_t n) {
+        return r * (2 * n - r - 1) / 2;
+    }
+    
+    // Read the frequent 2-itemsets out of the pair matrix, in itemset order
+    ItemsetStore readFrequentPairs(const vector<uint32_t>& items, const vector<uint32_t>& matrix) {
+        ItemsetStore frequent_pairs(2);
+        size_t index = 0;
+        for (size_t r = 0; r < items.size(); r++) {
+            for (size_t c = r + 1; c < items.size(); c++, index++) {
+                if ((int)matrix[index] >= min_support) {
+                    uint32_t pair[2] = {items[r], items[c]};
+                    frequent_pairs.append(pair, matrix[index]);
+                }
+            }
+        }
+        
+        return frequent_pairs;
+    }
+    
+    // Shrink the working set before counting the next level: drop items that occur
+    // in no candidate, then drop transactions too short to contain a candidate
+    void trimWorkingSet(const ItemsetStore& candidates, size_t min_length,
+                        vector<vector<uint32_t>>& working, vector<int>& working_weights) {
+        vector<char> live_items(item_names.size(), 0);
+        for (size_t c = 0; c < candidates.size(); c++) {
+            for (size_t i = 0; i < candidates.itemsetWidth(); i++) {
+                live_items[candidates.itemset(c)[i]] = 1;
+            }
+        }
+        
+        size_t kept = 0;
+        for (size_t t = 0; t < working.size(); t++) {
+            vector<uint32_t>& transaction = working[t];
+            transaction.erase(remove_if(transaction.begin(), transaction.end(),
+                                        [&](uint32_t item) { return !live_items[item]; }),
+                              transaction.end());
+            if (transaction.size() < min_length) continue;
+            
+            // Compact surviving transactions towards the front
+            if (kept != t) {
+                working[kept].swap(transaction);
+                working_weights[kept] = working_weights[t];
+            }
+            kept++;
+        }
+        
+        working.resize(kept);
+        working_weights.resize(kept);
+    }
+    
+    // Filter candidates by minimum support; the level is moved in and out, not copied
+    ItemsetStore filterBySupport(ItemsetStore candidates) {
+        candidates.retainAtLeast(min_support);
+        return candidates;
+    }
+    
+    // Main Apriori algorithm
+    map<vector<uint32_t>, int> runApriori() {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Sequential Apriori Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl << endl;
+        
+        auto all_frequent_itemsets = mineApriori(true);
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential Apriori completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential" << endl << duration.count() << endl;
+        result.close();
+        
+        return all_frequent_itemsets;
+    }
+    
+    // Level-wise Apriori over the loaded transactions, reporting every level when verbose
+    map<vector<uint32_t>, int> mineApriori(bool verbose) {
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        
+        // Generate frequent 1-itemsets
+        auto frequent_k = generateFrequent1Itemsets();
+        if (verbose) cout << "Frequent 1-itemsets: " << frequent_k.size() << endl;
+        
+        // Add to all frequent itemsets
+        frequent_k.addTo(all_frequent_itemsets);
+        
+        // Working set scanned by the level loop, trimmed in place as levels progress
+        vector<vector<uint32_t>> working_transactions = transactions;
+        vector<int> working_weights = transaction_weights;
+        
+        int k = 1;
+        while (!frequent_k.empty()) {
+            if (k == 1 && pairMatrixFits(frequent_k.size())) {
+                // Level 2: count all pairs of frequent items directly instead of
+                // materializing them as candidates
+                if (verbose) {
+                    cout << "Generated " << frequent_k.size() * (frequent_k.size() - 1) / 2
+                         << " candidates for level 2 (pair matrix)" << endl;
+                }
+                
+                trimWorkingSet(frequent_k, 2, working_transactions, working_weights);
+                if (verbose) cout << "Working set for level 2: " << working_transactions.size() << " transactions" << endl;
+                
+                frequent_k = countFrequentPairs(frequent_k, working_transactions, working_weights);
+            } else {
+                // Generate candidates for next level
+                auto candidates = generateCandidates(frequent_k);
+                if (candidates.empty()) break;
+                
+                if (verbose) cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
+                
+                trimWorkingSet(candidates, k + 1, working_transactions, working_weights);
+                if (verbose) {
+                    cout << "Working set for level " << (k+1) << ": " << working_transactions.size()
+                         << " transactions" << endl;
+                }
+                
+                // Count support
+                countSupport(candidates, working_transactions, working_weights);
+                
+                // Filter by minimum support
+                frequent_k = filterBySupport(move(candidates));
+            }
+            
+            if (verbose) cout << "Frequent " << (k+1) << "-itemsets: " << frequent_k.size() << endl;
+            
+            // Add to all frequent itemsets
+            frequent_k.addTo(all_frequent_itemsets);
+            
+            k++;
+        }
+        
+        return all_frequent_itemsets;
+    }
+    
+    // Sampling (Toivonen): mine a random sample of the loaded transactions at a
+    // lowered threshold, then count the sample's frequent itemsets and their negative
+    // border in one pass over all transactions. If no border itemset is frequent the
+    // result is exact; otherwise further passes extend the border until none is.
+    map<vector<uint32_t>, int> runSampling(double sample_fraction) {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Sequential Sampling Apriori (Toivonen) ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl;
+        
+        // Draw every transaction with the sample probability, duplicates independently
+        SequentialApriori sample(1);
+        mt19937 generator(SAMPLE_SEED);
+        for (size_t t = 0; t < transactions.size(); t++) {
+            binomial_distribution<int> draw(transaction_weights[t], sample_fraction);
+            int drawn = draw(generator);
+            if (drawn == 0) continue;
+            
+            sample.transactions.push_back(transactions[t]);
+            sample.transaction_weights.push_back(drawn);
+            sample.total_transactions += drawn;
+        }
+        sample.item_names = item_names;
+        sample.unit_weights = (sample.transactions.size() == (size_t)sample.total_transactions);
+        
+        // Lower the scaled threshold by the Chernoff margin for SAMPLE_MISS_PROBABILITY:
+        // an itemset at the threshold has an expected sample count of `expected`
+        double expected = (double)sample.total_transactions * min_support / max(total_transactions, 1);
+        double margin = sqrt(2 * expected * log(1.0 / SAMPLE_MISS_PROBABILITY));
+        sample.min_support = max(1, (int)floor(expected - margin));
+        
+        auto sample_frequent = sample.mineApriori(false);
+        cout << "Sample: " << sample.total_transactions << " transactions, lowered support "
+             << sample.min_support << ", " << sample_frequent.size() << " frequent itemsets" << endl;
+        
+        // Pass 1 over all transactions: the sample's frequent itemsets and their border
+        auto counted = countBySize(borderCandidates(sample_frequent), transactions, transaction_weights);
+        cout << "Pass 1: " << counted.size() << " itemsets counted" << endl;
+        
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        size_t misses = 0;
+        for (const auto& pair : counted) {
+            if (pair.second < min_support) continue;
+            all_frequent_itemsets.emplace_hint(all_frequent_itemsets.end(), pair);
+            if (sample_frequent.find(pair.first) == sample_frequent.end()) misses++;
+        }
+        
+        if (misses == 0) {
+            cout << "No negative border itemset is frequent: the result is exact" << endl;
+        } else {
+            cout << misses << " negative border itemsets are frequent: a second pass is needed" << endl;
+        }
+        
+        // Count the uncounted part of the border of the frequent itemsets until every
+        // border itemset is known to be infrequent
+        int passes = 1;
+        while (misses > 0) {
+            map<vector<uint32_t>, int> candidates;
+            for (const auto& pair : borderCandidates(all_frequent_itemsets)) {
+                if (counted.find(pair.first) == counted.end()) candidates.insert(pair);
+            }
+            if (candidates.empty()) break;
+            
+            misses = 0;
+            for (const auto& pair : countBySize(candidates, transactions, transaction_weights)) {
+                counted.insert(pair);
+                if (pair.second >= min_support) {
+                    all_frequent_itemsets.insert(pair);
+                    misses++;
+                }
+            }
+            passes++;
+            cout << "Pass " << passes << ": " << candidates.size() << " itemsets counted, "
+                 << misses << " frequent" << endl;
+        }
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential Sampling completed!" << endl;
+        cout << "Full passes: " << passes << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential_Sampling" << endl << duration.count() << endl;
+        result.close();
+        
+        return all_frequent_itemsets;
+    }
+    
+    // Partition (Savasere et al.): mine the text file in chunks of about budget_bytes
+    // without ever loading it whole. Pass 1 mines every chunk at a threshold scaled
+    // to its share of the file; any globally frequent itemset is locally frequent in
+    // some chunk, so the union of the local results is a complete candidate set.
+    // Pass 2 streams the file once more to count the candidates exactly. Returns
+    // false when the file is not a readable text file.
+    bool runPartition(const string& filename, size_t budget_bytes,
+                      map<vector<uint32_t>, int>& all_frequent_itemsets) {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Sequential Partition Algorithm ===" << endl;
+        cout << "Minimum support: " << min_support << endl;
+        
+        struct stat file_stat;
+        if (isBinaryDatabase(filename) || stat(filename.c_str(), &file_stat) != 0) {
+            cerr << "Error: Partition mode needs a readable text file" << endl;
+            return false;
+        }
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            return false;
+        }
+        
+        // Equal chunks, so no chunk gets a tiny share and a tiny local threshold
+        size_t file_size = file_stat.st_size;
+        size_t chunk_count = max((size_t)1, (file_size + budget_bytes - 1) / max(budget_bytes, (size_t)1));
+        size_t chunk_bytes = (file_size + chunk_count - 1) / chunk_count;
+        cout << "Chunks: " << chunk_count << " of about " << chunk_bytes << " bytes" << endl << endl;
+        
+        // Pass 1: mine every chunk, with item IDs assigned in order of appearance
+        unordered_map<string, uint32_t> item_ids;
+        set<vector<uint32_t>> global_candidates;
+        string line;
+        vector<uint32_t> transaction;
+        size_t consumed = 0;
+        total_transactions = 0;
+        
+        for (int chunk_index = 1; file.peek() != EOF; chunk_index++) {
+            SequentialApriori chunk(1);
+            size_t bytes = 0;
+            while (bytes < chunk_bytes && getline(file, line)) {
+                bytes += line.size() + 1;
+                if (!parseTransaction(line, item_ids, transaction)) continue;
+                
+                sort(transaction.begin(), transaction.end());
+                transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+                chunk.transactions.push_back(transaction);
+            }
+            bytes = min(bytes, file_size - consumed);
+            consumed += bytes;
+            
+            // ceil(s * b / B) - 1 < s * b / B, so an itemset below every local threshold
+            // has a total count below the sum of the chunk shares of s
+            chunk.min_support = max((size_t)1, (size_t)ceil((double)min_support * bytes / file_size));
+            chunk.total_transactions = chunk.transactions.size();
+            chunk.item_names.resize(item_ids.size());
+            chunk.collapseDuplicateTransactions();
+            total_transactions += chunk.total_transactions;
+            
+            auto local_frequent = chunk.mineApriori(false);
+            for (const auto& pair : local_frequent) {
+                global_candidates.insert(pair.first);
+            }
+            cout << "Chunk " << chunk_index << ": " << chunk.total_transactions << " transactions, local support "
+                 << chunk.min_support << ", " << local_frequent.size() << " locally frequent itemsets" << endl;
+        }
+        
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Global candidates: " << global_candidates.size() << endl;
+        
+        // Renumber items in name order and rewrite the candidates, grouped by size
+        buildItemDictionary(item_ids);
+        vector<uint32_t> new_ids(item_ids.size());
+        for (const auto& pair : item_ids) {
+            new_ids[pair.second] = lower_bound(item_names.begin(), item_names.end(), pair.first) - item_names.begin();
+        }
+        
+        vector<ItemsetStore> candidates_by_size;
+        for (const auto& candidate : global_candidates) {
+            vector<uint32_t> itemset;
+            for (uint32_t item : candidate) {
+                itemset.push_back(new_ids[item]);
+            }
+            sort(itemset.begin(), itemset.end());
+            while (candidates_by_size.size() <= itemset.size()) {
+                candidates_by_size.push_back(ItemsetStore(candidates_by_size.size()));
+            }
+            candidates_by_size[itemset.size()].append(itemset.data(), 0);
+        }
+        set<vector<uint32_t>>().swap(global_candidates);
+        
+        vector<CandidateTrie> tries;
+        vector<vector<int>> counts;
+        for (auto& candidates : candidates_by_size) {
+            candidates.sortItemsets();
+            tries.push_back(CandidateTrie(candidates));
+            counts.push_back(vector<int>(candidates.size(), 0));
+        }
+        
+        // Pass 2: stream the file and count every candidate exactly
+        file.clear();
+        file.seekg(0);
+        while (getline(file, line)) {
+            if (!parseTransaction(line, item_ids, transaction)) continue;
+            
+            for (uint32_t& item : transaction) {
+                item = new_ids[item];
+            }
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+            
+            for (size_t size = 1; size < tries.size(); size++) {
+                if (transaction.size() < size) break;
+                tries[size].count(transaction, 1, counts[size]);
+            }
+        }
+        file.close();
+        
+        for (size_t size = 1; size < candidates_by_size.size(); size++) {
+            ItemsetStore& frequent = candidates_by_size[size];
+            copy(counts[size].begin(), counts[size].end(), frequent.countData());
+            frequent.retainAtLeast(min_support);
+            frequent.addTo(all_frequent_itemsets);
+            cout << "Frequent " << size << "-itemsets: " << frequent.size() << endl;
+        }
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential Partition completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential_Partition" << endl << duration.count() << endl;
+        result.close();
+        
+        return true;
+    }
     
-    // Read transactions from file
-    bool loadTransactions(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cerr << "Error: Cannot open file " << filename << endl;
+    // FUP incremental mining (Cheung et al.) for a text file that only grows by
+    // appended lines. <filename>.state keeps the counts of the previous run's
+    // frequent itemsets and of their negative border (the candidates that proved
+    // infrequent), and the number of bytes they cover. Only the appended lines are
+    // scanned at every level. The old lines are read and rescanned only for
+    // candidates without a stored count whose appended count plus a bound on their
+    // old count reaches the threshold, so the result equals mining the whole file.
+    // Returns false when the file is not a readable text file.
+    bool runIncremental(const string& filename, map<vector<uint32_t>, int>& all_frequent_itemsets) {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Sequential Incremental Apriori (FUP) ===" << endl;
+        cout << "Minimum support: " << min_support << endl;
+        
+        struct stat file_stat;
+        if (isBinaryDatabase(filename) || stat(filename.c_str(), &file_stat) != 0) {
+            cerr << "Error: Incremental mode needs a readable text file" << endl;
             return false;
         }
+        uint64_t file_size = file_stat.st_size;
+        string state_file = filename + ".state";
         
-        string line;
-        transactions.clear();
+        IncrementalState state;
+        if (!loadIncrementalState(state_file, filename, file_size, state)) {
+            cout << "No usable state in " << state_file << ", mining the whole file" << endl << endl;
+            if (!loadTransactions(filename)) return false;
+            
+            all_frequent_itemsets = mineApriori(true);
+            auto known_counts = countNegativeBorder(all_frequent_itemsets);
+            known_counts.insert(all_frequent_itemsets.begin(), all_frequent_itemsets.end());
+            saveIncrementalState(state_file, total_transactions, file_size, known_counts);
+            reportIncremental(start, all_frequent_itemsets);
+            return true;
+        }
         
-        while (getline(file, line)) {
-            if (line.empty()) continue;
+        // Old counts, with item IDs assigned in order of appearance
+        unordered_map<string, uint32_t> item_ids;
+        map<vector<uint32_t>, int> old_counts;
+        size_t old_frequent = 0;
+        for (const auto& pair : state.itemsets) {
+            vector<uint32_t> itemset;
+            for (const string& name : pair.first) {
+                itemset.push_back(item_ids.insert(make_pair(name, (uint32_t)item_ids.size())).first->second);
+            }
+            sort(itemset.begin(), itemset.end());
+            old_counts[itemset] = pair.second;
+            if (pair.second >= min_support) old_frequent++;
+        }
+        
+        // The appended lines become the loaded transactions
+        readTextRange(filename, state.bytes, file_size, item_ids, transactions);
+        int new_transactions = transactions.size();
+        total_transactions = new_transactions;
+        collapseDuplicateTransactions();
+        
+        cout << "Previous run: " << state.transactions << " transactions, "
+             << old_frequent << " frequent itemsets, "
+             << old_counts.size() - old_frequent << " in the negative border" << endl;
+        cout << "Appended transactions: " << new_transactions << endl << endl;
+        
+        // The old transactions are only read once a candidate needs them
+        vector<vector<uint32_t>> old_transactions;
+        vector<int> old_weights;
+        bool old_loaded = false;
+        
+        // Level 1 candidates: every item with an old count and every appended item
+        map<vector<uint32_t>, int> candidates;
+        for (const auto& pair : old_counts) {
+            if (pair.first.size() == 1) candidates[pair.first] = 0;
+        }
+        for (const auto& transaction : transactions) {
+            for (uint32_t item : transaction) {
+                candidates[vector<uint32_t>{item}] = 0;
+            }
+        }
+        
+        // Infrequent candidates whose exact count is known, kept for the next run
+        map<vector<uint32_t>, int> negative_border;
+        
+        int k = 1;
+        while (!candidates.empty()) {
+            item_names.resize(item_ids.size());
+            auto new_counts = countSupport(candidates, transactions, transaction_weights);
             
-            vector<string> transaction;
-            stringstream ss(line);
-            string item;
+            // Itemsets with an old count add it; others are rescanned when their
+            // appended count plus a bound on their old count reaches the threshold
+            map<vector<uint32_t>, int> frequent_k;
+            map<vector<uint32_t>, int> rescan;
+            for (const auto& pair : new_counts) {
+                auto old = old_counts.find(pair.first);
+                if (old != old_counts.end()) {
+                    int count = old->second + pair.second;
+                    (count >= min_support ? frequent_k : negative_border)[pair.first] = count;
+                } else if (pair.second + oldCountBound(pair.first, old_counts, state.transactions) >= min_support) {
+                    rescan.emplace_hint(rescan.end(), pair.first, pair.second);
+                }
+            }
             
-            while (getline(ss, item, ',')) {
-                // Trim whitespace
-                item.erase(0, item.find_first_not_of(" \t"));
-                item.erase(item.find_last_not_of(" \t") + 1);
+            if (!rescan.empty()) {
+                if (!old_loaded) {
+                    readTextRange(filename, 0, state.bytes, item_ids, old_transactions);
+                    collapseDuplicates(old_transactions, old_weights);
+                    item_names.resize(item_ids.size());
+                    old_loaded = true;
+                }
                 
-                if (!item.empty() && item != "-1") {
-                    transaction.push_back(item);
+                auto rescanned = countSupport(rescan, old_transactions, old_weights);
+                for (const auto& pair : rescanned) {
+                    int count = pair.second + rescan[pair.first];
+                    (count >= min_support ? frequent_k : negative_border)[pair.first] = count;
                 }
             }
             
-            if (!transaction.empty()) {
-                sort(transaction.begin(), transaction.end());
-                transactions.push_back(transaction);
+            cout << "Level " << k << ": " << candidates.size() << " candidates, "
+                 << rescan.size() << " rescanned in old data, " << frequent_k.size() << " frequent" << endl;
+            
+            for (const auto& pair : frequent_k) {
+                all_frequent_itemsets[pair.first] = pair.second;
             }
+            
+            candidates = generateCandidates(frequent_k);
+            k++;
         }
         
-        file.close();
-        cout << "Loaded " << transactions.size() << " transactions" << endl;
+        // Renumber items in name order, as a full run would
+        buildItemDictionary(item_ids);
+        vector<uint32_t> new_ids(item_ids.size());
+        for (const auto& pair : item_ids) {
+            new_ids[pair.second] = lower_bound(item_names.begin(), item_names.end(), pair.first) - item_names.begin();
+        }
+        
+        map<vector<uint32_t>, int> renumbered;
+        map<vector<uint32_t>, int> known_counts;
+        for (const auto& pair : all_frequent_itemsets) {
+            renumbered[renumberItemset(pair.first, new_ids)] = pair.second;
+        }
+        for (const auto& pair : negative_border) {
+            known_counts[renumberItemset(pair.first, new_ids)] = pair.second;
+        }
+        all_frequent_itemsets.swap(renumbered);
+        known_counts.insert(all_frequent_itemsets.begin(), all_frequent_itemsets.end());
+        
+        total_transactions = state.transactions + new_transactions;
+        saveIncrementalState(state_file, total_transactions, file_size, known_counts);
+        reportIncremental(start, all_frequent_itemsets);
+        
         return true;
     }
     
-    // Generate frequent 1-itemsets
-    map<vector<string>, int> generateFrequent1Itemsets() {
-        map<string, int> item_counts;
+    // Upper bound on the old count of an itemset without a stored count. Every old
+    // frequent itemset is stored, so it was below the threshold, and it is at most
+    // the old count of any of its stored subsets.
+    int oldCountBound(const vector<uint32_t>& itemset, const map<vector<uint32_t>, int>& old_counts,
+                      long long old_transactions) {
+        int bound = (int)min((long long)min_support - 1, old_transactions);
+        if (itemset.size() < 2) return bound;
         
-        // Count individual items
-        for (const auto& transaction : transactions) {
-            for (const string& item : transaction) {
-                item_counts[item]++;
+        vector<uint32_t> subset(itemset.begin() + 1, itemset.end());
+        for (size_t skip = 0; skip < itemset.size(); skip++) {
+            if (skip > 0) subset[skip - 1] = itemset[skip - 1];
+            auto old = old_counts.find(subset);
+            if (old != old_counts.end()) bound = min(bound, old->second);
+        }
+        
+        return bound;
+    }
+    
+    // Count the negative border of the frequent itemsets over the loaded transactions:
+    // the infrequent single items and every infrequent Apriori candidate
+    map<vector<uint32_t>, int> countNegativeBorder(const map<vector<uint32_t>, int>& frequent_itemsets) {
+        map<vector<uint32_t>, int> border;
+        for (const auto& pair : countBySize(borderCandidates(frequent_itemsets), transactions, transaction_weights)) {
+            if (pair.second < min_support) border.emplace_hint(border.end(), pair);
+        }
+        
+        return border;
+    }
+    
+    // A downward-closed set of itemsets together with its negative border: every
+    // single item and every Apriori candidate generated from each level of the set
+    map<vector<uint32_t>, int> borderCandidates(const map<vector<uint32_t>, int>& itemsets) {
+        vector<map<vector<uint32_t>, int>> itemsets_by_size;
+        for (const auto& pair : itemsets) {
+            if (itemsets_by_size.size() <= pair.first.size()) itemsets_by_size.resize(pair.first.size() + 1);
+            itemsets_by_size[pair.first.size()].emplace_hint(itemsets_by_size[pair.first.size()].end(), pair);
+        }
+        
+        map<vector<uint32_t>, int> candidates;
+        for (uint32_t item = 0; item < item_names.size(); item++) {
+            candidates.emplace_hint(candidates.end(), vector<uint32_t>{item}, 0);
+        }
+        for (size_t k = 1; k < itemsets_by_size.size(); k++) {
+            auto generated = generateCandidates(itemsets_by_size[k]);
+            candidates.insert(generated.begin(), generated.end());
+        }
+        
+        return candidates;
+    }
+    
+    // Count candidates of any sizes in a single pass, with one prefix trie per size
+    map<vector<uint32_t>, int> countBySize(const map<vector<uint32_t>, int>& candidates,
+                                           const vector<vector<uint32_t>>& database,
+                                           const vector<int>& weights) {
+        // The map is sorted, so every size comes out sorted too
+        vector<ItemsetStore> candidates_by_size;
+        for (const auto& pair : candidates) {
+            while (candidates_by_size.size() <= pair.first.size()) {
+                candidates_by_size.push_back(ItemsetStore(candidates_by_size.size()));
             }
+            candidates_by_size[pair.first.size()].append(pair.first.data(), 0);
         }
         
-        // Filter by minimum support
-        map<vector<string>, int> frequent_1_itemsets;
-        for (const auto& pair : item_counts) {
-            if (pair.second >= min_support) {
-                vector<string> itemset = {pair.first};
-                frequent_1_itemsets[itemset] = pair.second;
+        vector<CandidateTrie> tries;
+        vector<vector<int>> counts;
+        for (const auto& sized : candidates_by_size) {
+            tries.push_back(CandidateTrie(sized));
+            counts.push_back(vector<int>(sized.size(), 0));
+        }
+        
+        for (size_t t = 0; t < database.size(); t++) {
+            for (size_t size = 1; size < tries.size(); size++) {
+                if (database[t].size() < size) break;
+                tries[size].count(database[t], weights[t], counts[size]);
             }
         }
         
-        return frequent_1_itemsets;
+        map<vector<uint32_t>, int> support_counts;
+        for (size_t size = 1; size < candidates_by_size.size(); size++) {
+            copy(counts[size].begin(), counts[size].end(), candidates_by_size[size].countData());
+            candidates_by_size[size].addTo(support_counts);
+        }
+        
+        return support_counts;
     }
     
-    // Generate candidate itemsets from frequent k-itemsets
-    map<vector<string>, int> generateCandidates(const map<vector<string>, int>& frequent_k) {
-        map<vector<string>, int> candidates;
-        vector<vector<string>> itemsets;
+    vector<uint32_t> renumberItemset(const vector<uint32_t>& itemset, const vector<uint32_t>& new_ids) {
+        vector<uint32_t> renumbered;
+        for (uint32_t item : itemset) {
+            renumbered.push_back(new_ids[item]);
+        }
+        sort(renumbered.begin(), renumbered.end());
+        return renumbered;
+    }
+    
+    // Read the lines in bytes [begin, end) of a text file as sorted transactions
+    void readTextRange(const string& filename, uint64_t begin, uint64_t end,
+                       unordered_map<string, uint32_t>& item_ids, vector<vector<uint32_t>>& parsed) {
+        ifstream file(filename, ios::binary);
+        file.seekg(begin);
         
-        // Extract itemsets
-        for (const auto& pair : frequent_k) {
-            itemsets.push_back(pair.first);
+        string line;
+        vector<uint32_t> transaction;
+        uint64_t position = begin;
+        while (position < end && getline(file, line)) {
+            position += line.size() + 1;
+            if (!parseTransaction(line, item_ids, transaction)) continue;
+            
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+            parsed.push_back(transaction);
         }
+    }
+    
+    // Collapse identical sorted transactions of a database into weighted transactions
+    void collapseDuplicates(vector<vector<uint32_t>>& database, vector<int>& weights) {
+        sort(database.begin(), database.end());
+        weights.clear();
         
-        // Generate candidates by joining frequent itemsets
-        for (size_t i = 0; i < itemsets.size(); i++) {
-            for (size_t j = i + 1; j < itemsets.size(); j++) {
-                vector<string> candidate = itemsets[i];
-                
-                // Check if first k-1 items are the same
-                bool can_join = true;
-                if (candidate.size() > 0) {
-                    for (size_t k = 0; k < candidate.size() - 1; k++) {
-                        if (itemsets[i][k] != itemsets[j][k]) {
-                            can_join = false;
-                            break;
-                        }
-                    }
-                }
-                
-                if (can_join) {
-                    candidate.push_back(itemsets[j].back());
-                    sort(candidate.begin(), candidate.end());
-                    candidates[candidate] = 0;
-                }
+        size_t distinct = 0;
+        for (size_t i = 0; i < database.size(); i++) {
+            if (distinct > 0 && database[i] == database[distinct - 1]) {
+                weights.back()++;
+                continue;
             }
+            if (i != distinct) {
+                database[distinct].swap(database[i]);
+            }
+            weights.push_back(1);
+            distinct++;
+        }
+        database.resize(distinct);
+    }
+    
+    // Read the state of the previous incremental run. It is only usable when it was
+    // mined at the same threshold and covers a line-aligned prefix of the file.
+    bool loadIncrementalState(const string& state_file, const string& filename, uint64_t file_size,
+                              IncrementalState& state) {
+        ifstream file(state_file);
+        string magic;
+        int state_support;
+        if (!(file >> magic >> state_support >> state.transactions >> state.bytes) ||
+            magic != "APRIORI_STATE_1" || state_support != min_support || state.bytes > file_size) {
+            return false;
         }
         
-        return candidates;
+        if (state.bytes > 0) {
+            ifstream data(filename, ios::binary);
+            data.seekg(state.bytes - 1);
+            if (data.get() != '\n') return false;
+        }
+        
+        string line;
+        getline(file, line);
+        while (getline(file, line)) {
+            size_t tab = line.find('\t');
+            if (tab == string::npos) return false;
+            
+            vector<string> names;
+            stringstream ss(line.substr(tab + 1));
+            string name;
+            while (getline(ss, name, ',')) {
+                names.push_back(name);
+            }
+            state.itemsets.push_back(make_pair(names, atoi(line.c_str())));
+        }
+        
+        return true;
+    }
+    
+    // Write the threshold, transaction count and covered bytes, then one
+    // "count<TAB>item,item,..." line per itemset with a known count
+    void saveIncrementalState(const string& state_file, long long transaction_count, uint64_t bytes,
+                              const map<vector<uint32_t>, int>& known_counts) {
+        ofstream file(state_file);
+        file << "APRIORI_STATE_1 " << min_support << " " << transaction_count << " " << bytes << "\n";
+        for (const auto& pair : known_counts) {
+            file << pair.second << '\t';
+            for (size_t i = 0; i < pair.first.size(); i++) {
+                if (i > 0) file << ',';
+                file << item_names[pair.first[i]];
+            }
+            file << '\n';
+        }
     }
     
-    // Check if itemset is subset of transaction
-    bool isSubset(const vector<string>& itemset, const vector<string>& transaction) {
-        return includes(transaction.begin(), transaction.end(),
-                       itemset.begin(), itemset.end());
+    void reportIncremental(high_resolution_clock::time_point start,
+                           const map<vector<uint32_t>, int>& frequent_itemsets) {
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential Incremental Apriori completed!" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Total frequent itemsets: " << frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential_Incremental" << endl << duration.count() << endl;
+        result.close();
     }
     
-    // Count support for candidates
-    map<vector<string>, int> countSupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> support_counts;
+    // Support of one bitset word: its popcount when every transaction has weight
+    // one, otherwise the summed weights of the transactions whose bits are set
+    int wordSupport(uint64_t word, size_t w) {
+        if (unit_weights) return __builtin_popcountll(word);
         
-        for (const auto& candidate_pair : candidates) {
-            int count = 0;
-            for (const auto& transaction : transactions) {
-                if (isSubset(candidate_pair.first, transaction)) {
-                    count++;
-                }
+        int support = 0;
+        while (word) {
+            support += transaction_weights[w * 64 + __builtin_ctzll(word)];
+            word &= word - 1;
+        }
+        return support;
+    }
+    
+    // AND two transaction bitsets into out and return the support of the result
+    int intersectTidsets(const vector<uint64_t>& a, const vector<uint64_t>& b, vector<uint64_t>& out) {
+        int support = 0;
+        for (size_t w = 0; w < a.size(); w++) {
+            out[w] = a[w] & b[w];
+            support += wordSupport(out[w], w);
+        }
+        return support;
+    }
+    
+    // Build the vertical layout: one bitset of transaction IDs per frequent item
+    vector<EclatMember> buildVerticalLayout() {
+        size_t words = (transactions.size() + 63) / 64;
+        vector<vector<uint64_t>> item_tids(item_names.size(), vector<uint64_t>(words, 0));
+        
+        for (size_t t = 0; t < transactions.size(); t++) {
+            for (uint32_t item : transactions[t]) {
+                item_tids[item][t / 64] |= 1ULL << (t % 64);
             }
-            support_counts[candidate_pair.first] = count;
         }
         
-        return support_counts;
+        vector<EclatMember> frequent_items;
+        for (uint32_t item = 0; item < item_tids.size(); item++) {
+            int support = 0;
+            for (size_t w = 0; w < item_tids[item].size(); w++) {
+                support += wordSupport(item_tids[item][w], w);
+            }
+            
+            if (support >= min_support) {
+                EclatMember member;
+                member.item = item;
+                member.support = support;
+                member.tids.swap(item_tids[item]);
+                frequent_items.push_back(member);
+            }
+        }
+        
+        return frequent_items;
     }
     
-    // Filter candidates by minimum support
-    map<vector<string>, int> filterBySupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> frequent;
+    // Depth-first extension of a prefix class: each member joined with every later member
+    void extendPrefixClass(vector<uint32_t>& prefix, const vector<EclatMember>& members,
+                           map<vector<uint32_t>, int>& results) {
+        vector<uint64_t> scratch;
         
-        for (const auto& pair : candidates) {
-            if (pair.second >= min_support) {
-                frequent[pair.first] = pair.second;
+        for (size_t i = 0; i < members.size(); i++) {
+            prefix.push_back(members[i].item);
+            results[prefix] = members[i].support;
+            
+            vector<EclatMember> child_class;
+            for (size_t j = i + 1; j < members.size(); j++) {
+                scratch.resize(members[i].tids.size());
+                int support = intersectTidsets(members[i].tids, members[j].tids, scratch);
+                
+                if (support >= min_support) {
+                    EclatMember child;
+                    child.item = members[j].item;
+                    child.support = support;
+                    child.tids.swap(scratch);
+                    child_class.push_back(child);
+                }
+            }
+            
+            if (!child_class.empty()) {
+                extendPrefixClass(prefix, child_class, results);
             }
+            prefix.pop_back();
         }
-        
-        return frequent;
     }
     
-    // Main Apriori algorithm
-    map<vector<string>, int> runApriori() {
+    // Eclat: depth-first mining over vertical bitsets, support = popcount of ANDed tidsets
+    map<vector<uint32_t>, int> runEclat() {
         auto start = high_resolution_clock::now();
         
-        cout << "\n=== Running Sequential Apriori Algorithm ===" << endl;
-        cout << "Total transactions: " << transactions.size() << endl;
+        cout << "\n=== Running Sequential Eclat Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
         cout << "Minimum support: " << min_support << endl << endl;
         
-        map<vector<string>, int> all_frequent_itemsets;
+        map<vector<uint32_t>, int> all_frequent_itemsets;
         
-        // Generate frequent 1-itemsets
-        auto frequent_k = generateFrequent1Itemsets();
-        cout << "Frequent 1-itemsets: " << frequent_k.size() << endl;
+        auto frequent_items = buildVerticalLayout();
+        vector<uint32_t> prefix;
+        extendPrefixClass(prefix, frequent_items, all_frequent_itemsets);
         
-        // Add to all frequent itemsets
-        for (const auto& pair : frequent_k) {
-            all_frequent_itemsets[pair.first] = pair.second;
+        // Report per-level totals in the same shape as the Apriori run
+        map<size_t, int> level_counts;
+        for (const auto& pair : all_frequent_itemsets) {
+            level_counts[pair.first.size()]++;
+        }
+        for (const auto& level : level_counts) {
+            cout << "Frequent " << level.first << "-itemsets: " << level.second << endl;
         }
         
-        int k = 1;
-        while (!frequent_k.empty()) {
-            // Generate candidates for next level
-            auto candidates = generateCandidates(frequent_k);
-            if (candidates.empty()) break;
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential Eclat completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential_Eclat" << endl << duration.count() << endl;
+        result.close();
+        
+        return all_frequent_itemsets;
+    }
+    
+    // FNV-1a hash over the words of a transaction bitset
+    uint64_t hashTidset(const vector<uint64_t>& tids) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (uint64_t word : tids) {
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    
+    // CHARM extension of a class. A join whose tidset contains the member's tidset
+    // folds the other member's items into this member instead of branching, and a
+    // join whose tidset is contained in it replaces the other member. The itemset is
+    // closed unless an already found closed itemset has the same tidset.
+    void extendClosedClass(const vector<uint32_t>& prefix, vector<ClosedMember>& members,
+                           map<vector<uint32_t>, int>& closed,
+                           unordered_map<uint64_t, vector<vector<uint32_t>>>& closed_by_tids) {
+        stable_sort(members.begin(), members.end(), [](const ClosedMember& a, const ClosedMember& b) {
+            return a.support < b.support;
+        });
+        
+        vector<bool> removed(members.size(), false);
+        vector<uint64_t> scratch;
+        for (size_t i = 0; i < members.size(); i++) {
+            if (removed[i]) continue;
             
-            cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
+            vector<uint32_t> itemset = prefix;
+            itemset.insert(itemset.end(), members[i].items.begin(), members[i].items.end());
             
-            // Count support
-            auto support_counts = countSupport(candidates);
+            vector<ClosedMember> child_class;
+            for (size_t j = i + 1; j < members.size(); j++) {
+                if (removed[j]) continue;
+                
+                scratch.resize(members[i].tids.size());
+                int support = intersectTidsets(members[i].tids, members[j].tids, scratch);
+                if (support < min_support) continue;
+                
+                // Weights are positive, so equal support means tidset containment
+                if (support == members[j].support) removed[j] = true;
+                if (support == members[i].support) {
+                    itemset.insert(itemset.end(), members[j].items.begin(), members[j].items.end());
+                } else {
+                    ClosedMember child;
+                    child.items = members[j].items;
+                    child.support = support;
+                    child.tids.swap(scratch);
+                    child_class.push_back(child);
+                }
+            }
+            sort(itemset.begin(), itemset.end());
             
-            // Filter by minimum support
-            frequent_k = filterBySupport(support_counts);
+            if (!child_class.empty()) {
+                extendClosedClass(itemset, child_class, closed, closed_by_tids);
+            }
             
-            cout << "Frequent " << (k+1) << "-itemsets: " << frequent_k.size() << endl;
+            vector<vector<uint32_t>>& same_tids = closed_by_tids[hashTidset(members[i].tids)];
+            bool subsumed = false;
+            for (const auto& other : same_tids) {
+                if (closed[other] == members[i].support &&
+                    includes(other.begin(), other.end(), itemset.begin(), itemset.end())) {
+                    subsumed = true;
+                    break;
+                }
+            }
+            if (!subsumed) {
+                closed[itemset] = members[i].support;
+                same_tids.push_back(itemset);
+            }
+        }
+    }
+    
+    // True when a maximal itemset found so far contains the itemset
+    bool coveredByMaximal(const vector<uint32_t>& itemset, const vector<vector<uint32_t>>& maximal) {
+        for (const auto& other : maximal) {
+            if (other.size() >= itemset.size() &&
+                includes(other.begin(), other.end(), itemset.begin(), itemset.end())) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // GenMax-style extension of a class in increasing support order. An item in every
+    // transaction of a member joins that member's itemset without branching, and a
+    // class whose prefix plus all of its items is already covered is skipped.
+    void extendMaximalClass(const vector<uint32_t>& prefix, vector<EclatMember>& members,
+                            map<vector<uint32_t>, int>& results, vector<vector<uint32_t>>& maximal) {
+        stable_sort(members.begin(), members.end(), [](const EclatMember& a, const EclatMember& b) {
+            return a.support < b.support;
+        });
+        
+        vector<uint32_t> lookahead = prefix;
+        for (const auto& member : members) {
+            lookahead.push_back(member.item);
+        }
+        sort(lookahead.begin(), lookahead.end());
+        if (coveredByMaximal(lookahead, maximal)) return;
+        
+        vector<uint64_t> scratch;
+        for (size_t i = 0; i < members.size(); i++) {
+            vector<uint32_t> itemset = prefix;
+            itemset.push_back(members[i].item);
             
-            // Add to all frequent itemsets
-            for (const auto& pair : frequent_k) {
-                all_frequent_itemsets[pair.first] = pair.second;
+            vector<EclatMember> child_class;
+            for (size_t j = i + 1; j < members.size(); j++) {
+                scratch.resize(members[i].tids.size());
+                int support = intersectTidsets(members[i].tids, members[j].tids, scratch);
+                if (support < min_support) continue;
+                
+                if (support == members[i].support) {
+                    itemset.push_back(members[j].item);
+                } else {
+                    EclatMember child;
+                    child.item = members[j].item;
+                    child.support = support;
+                    child.tids.swap(scratch);
+                    child_class.push_back(child);
+                }
             }
+            sort(itemset.begin(), itemset.end());
             
-            k++;
+            if (!child_class.empty()) {
+                extendMaximalClass(itemset, child_class, results, maximal);
+            } else if (!coveredByMaximal(itemset, maximal)) {
+                results[itemset] = members[i].support;
+                maximal.push_back(itemset);
+            }
+        }
+    }
+    
+    // Closed (CHARM) or maximal (GenMax) itemsets over the vertical bitsets. Both prune
+    // the search while mining rather than filtering the full frequent set afterwards.
+    map<vector<uint32_t>, int> runCondensed(bool maximal_only) {
+        auto start = high_resolution_clock::now();
+        
+        string name = maximal_only ? "Maximal" : "Closed";
+        cout << "\n=== Running Sequential " << name << " Itemset Mining ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl << endl;
+        
+        map<vector<uint32_t>, int> condensed_itemsets;
+        auto frequent_items = buildVerticalLayout();
+        if (maximal_only) {
+            vector<vector<uint32_t>> maximal;
+            extendMaximalClass(vector<uint32_t>(), frequent_items, condensed_itemsets, maximal);
+        } else {
+            vector<ClosedMember> members;
+            for (auto& item : frequent_items) {
+                ClosedMember member;
+                member.items.push_back(item.item);
+                member.support = item.support;
+                member.tids.swap(item.tids);
+                members.push_back(member);
+            }
+            unordered_map<uint64_t, vector<vector<uint32_t>>> closed_by_tids;
+            extendClosedClass(vector<uint32_t>(), members, condensed_itemsets, closed_by_tids);
+        }
+        
+        // Report per-level totals in the same shape as the Apriori run
+        map<size_t, int> level_counts;
+        for (const auto& pair : condensed_itemsets) {
+            level_counts[pair.first.size()]++;
+        }
+        for (const auto& level : level_counts) {
+            cout << name << " " << level.first << "-itemsets: " << level.second << endl;
         }
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
-        cout << "\nSequential Apriori completed!" << endl;
+        cout << "\nSequential " << name << " mining completed!" << endl;
+        cout << "Total " << (maximal_only ? "maximal" : "closed") << " itemsets: " << condensed_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("sequential_results.txt", ios::app);
+        result << "Sequential_" << name << endl << duration.count() << endl;
+        result.close();
+        
+        return condensed_itemsets;
+    }
+    
+    // Every frequent itemset is a subset of a closed itemset and has the largest
+    // support among its closed supersets. Closed itemsets are expanded in decreasing
+    // support, so a subset that is already present keeps its support, and so do all of
+    // its own subsets, which are present too.
+    map<vector<uint32_t>, int> expandClosedItemsets(const map<vector<uint32_t>, int>& closed) {
+        vector<pair<vector<uint32_t>, int>> ordered(closed.begin(), closed.end());
+        stable_sort(ordered.begin(), ordered.end(),
+                    [](const pair<vector<uint32_t>, int>& a, const pair<vector<uint32_t>, int>& b) {
+                        return a.second > b.second;
+                    });
+        
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        for (auto& pair : ordered) {
+            addClosedSubsets(pair.first, 0, pair.second, all_frequent_itemsets);
+        }
+        
+        cout << "Frequent itemsets derived from the closed itemsets: " << all_frequent_itemsets.size() << endl;
+        return all_frequent_itemsets;
+    }
+    
+    // Add the itemset and, in canonical order, every subset obtained by removing items
+    // at or after first_removable
+    void addClosedSubsets(vector<uint32_t>& itemset, size_t first_removable, int support,
+                          map<vector<uint32_t>, int>& results) {
+        if (itemset.empty() || !results.emplace(itemset, support).second) return;
+        
+        for (size_t r = first_removable; r < itemset.size(); r++) {
+            uint32_t item = itemset[r];
+            itemset.erase(itemset.begin() + r);
+            addClosedSubsets(itemset, r, support, results);
+            itemset.insert(itemset.begin() + r, item);
+        }
+    }
+    
+    // FP-Growth: two database passes to build the FP-tree, then recursive
+    // mining of conditional pattern bases with no candidate generation
+    map<vector<uint32_t>, int> runFPGrowth() {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Sequential FP-Growth Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl << endl;
+        
+        // First pass: frequent items, ordered by descending support
+        vector<pair<uint32_t, int>> frequent_items;
+        ItemsetStore frequent_1 = generateFrequent1Itemsets();
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            frequent_items.push_back(make_pair(frequent_1.itemset(i)[0], frequent_1.count(i)));
+        }
+        FPTree::sortBySupport(frequent_items);
+        
+        // Second pass: build the FP-tree
+        FPTree tree(min_support);
+        tree.setHeader(frequent_items);
+        for (size_t t = 0; t < transactions.size(); t++) {
+            tree.insert(transactions[t], transaction_weights[t]);
+        }
+        
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        vector<uint32_t> suffix;
+        tree.mine(suffix, all_frequent_itemsets);
+        
+        // Report per-level totals in the same shape as the Apriori run
+        map<size_t, int> level_counts;
+        for (const auto& pair : all_frequent_itemsets) {
+            level_counts[pair.first.size()]++;
+        }
+        for (const auto& level : level_counts) {
+            cout << "Frequent " << level.first << "-itemsets: " << level.second << endl;
+        }
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nSequential FP-Growth completed!" << endl;
         cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
         cout << "Execution time: " << duration.count() << " ms" << endl;
         
         // Save timing results
         ofstream result("sequential_results.txt", ios::app);
-        result << "Sequential" << endl << duration.count() << endl;
+        result << "Sequential_FPGrowth" << endl << duration.count() << endl;
         result.close();
         
         return all_frequent_itemsets;
     }
     
-    void printResults(const map<vector<string>, int>& frequent_itemsets) {
+    void printResults(const map<vector<uint32_t>, int>& frequent_itemsets) {
         cout << "\n=== FREQUENT ITEMSETS ===" << endl;
         
         // Group by size for better readability
-        map<int, vector<pair<vector<string>, int>>> grouped_results;
+        map<int, vector<pair<vector<uint32_t>, int>>> grouped_results;
         
         for (const auto& pair : frequent_itemsets) {
             grouped_results[pair.first.size()].push_back(pair);
@@ -229,7 +2074,7 @@ public:
             for (const auto& pair : group.second) {
                 cout << "{ ";
                 for (size_t i = 0; i < pair.first.size(); i++) {
-                    cout << pair.first[i];
+                    cout << item_names[pair.first[i]];
                     if (i < pair.first.size() - 1) cout << ", ";
                 }
                 cout << " } : " << pair.second << endl;
@@ -241,6 +2086,7 @@ public:
 int main() {
     string filename;
     int min_support;
+    int mode;
     
     cout << "=== Sequential Apriori Algorithm ===" << endl;
     cout << "Enter data filename: ";
@@ -249,6 +2095,17 @@ int main() {
     cout << "Enter minimum support count: ";
     cin >> min_support;
     
+    cout << "Select mode:" << endl;
+    cout << "1. Apriori" << endl;
+    cout << "2. Eclat (vertical bitsets)" << endl;
+    cout << "3. FP-Growth" << endl;
+    cout << "4. Partition (out-of-core, two passes)" << endl;
+    cout << "5. Incremental (FUP, reuses <file>.state from the last run)" << endl;
+    cout << "6. Sampling (Toivonen, verified in one full pass)" << endl;
+    cout << "7. Closed itemsets (CHARM)" << endl;
+    cout << "8. Maximal itemsets (GenMax)" << endl;
+    if (!(cin >> mode)) mode = 1;
+    
     if (min_support <= 0) {
         cerr << "Error: Minimum support must be positive" << endl;
         return 1;
@@ -256,12 +2113,70 @@ int main() {
     
     SequentialApriori apriori(min_support);
     
+    // Partition mode streams the file itself instead of loading it
+    if (mode == 4) {
+        size_t budget_mb = 64;
+        cout << "Enter memory budget per chunk in MB: ";
+        cin >> budget_mb;
+        
+        map<vector<uint32_t>, int> frequent_itemsets;
+        if (!apriori.runPartition(filename, max(budget_mb, (size_t)1) << 20, frequent_itemsets)) {
+            return 1;
+        }
+        apriori.printResults(frequent_itemsets);
+        return 0;
+    }
+    
+    // Incremental mode reads only what it needs of the file
+    if (mode == 5) {
+        map<vector<uint32_t>, int> frequent_itemsets;
+        if (!apriori.runIncremental(filename, frequent_itemsets)) {
+            return 1;
+        }
+        apriori.printResults(frequent_itemsets);
+        return 0;
+    }
+    
+    double sample_percent = 10;
+    if (mode == 6) {
+        cout << "Enter sample size in percent of the transactions: ";
+        cin >> sample_percent;
+        sample_percent = min(max(sample_percent, 0.01), 100.0);
+    }
+    
+    int expand_closed = 0;
+    if (mode == 7) {
+        cout << "Derive all frequent itemsets from the closed itemsets (1 = yes, 0 = no): ";
+        cin >> expand_closed;
+    }
+    
     if (!apriori.loadTransactions(filename)) {
         return 1;
     }
     
-    auto frequent_itemsets = apriori.runApriori();
-    apriori.printResults(frequent_itemsets);
+    if (mode == 2) {
+        auto frequent_itemsets = apriori.runEclat();
+        apriori.printResults(frequent_itemsets);
+    } else if (mode == 3) {
+        auto frequent_itemsets = apriori.runFPGrowth();
+        apriori.printResults(frequent_itemsets);
+    } else if (mode == 6) {
+        auto frequent_itemsets = apriori.runSampling(sample_percent / 100);
+        apriori.printResults(frequent_itemsets);
+    } else if (mode == 7) {
+        auto closed_itemsets = apriori.runCondensed(false);
+        if (expand_closed) {
+            apriori.printResults(apriori.expandClosedItemsets(closed_itemsets));
+        } else {
+            apriori.printResults(closed_itemsets);
+        }
+    } else if (mode == 8) {
+        auto maximal_itemsets = apriori.runCondensed(true);
+        apriori.printResults(maximal_itemsets);
+    } else {
+        auto frequent_itemsets = apriori.runApriori();
+        apriori.printResults(frequent_itemsets);
+    }
     
     return 0;
 }
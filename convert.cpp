@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Header of the binary transaction database written by convert. The header is
+// followed by the item dictionary and the distinct transactions in CSR form,
+// with every section starting on an 8-byte boundary.
+struct BinaryDatabaseHeader {
+    char magic[8];                // "APRIODB1"
+    uint64_t item_count;
+    uint64_t transaction_count;   // Distinct transactions
+    uint64_t total_transactions;  // Transactions in the source file, duplicates included
+    uint64_t item_entries;        // Length of the items section
+    uint64_t names_bytes;
+};
+
+// Byte offsets of the sections that follow the header
+struct BinaryDatabaseLayout {
+    uint64_t name_offsets;  // uint64_t[item_count + 1] into names
+    uint64_t names;         // char[names_bytes], item names in ID order
+    uint64_t offsets;       // uint64_t[transaction_count + 1] into items
+    uint64_t weights;       // uint32_t[transaction_count]
+    uint64_t items;         // uint32_t[item_entries], sorted item IDs per transaction
+    uint64_t file_size;
+    
+    BinaryDatabaseLayout(const BinaryDatabaseHeader& header) {
+        name_offsets = align(sizeof(BinaryDatabaseHeader));
+        names = align(name_offsets + (header.item_count + 1) * sizeof(uint64_t));
+        offsets = align(names + header.names_bytes);
+        weights = align(offsets + (header.transaction_count + 1) * sizeof(uint64_t));
+        items = align(weights + header.transaction_count * sizeof(uint32_t));
+        file_size = items + header.item_entries * sizeof(uint32_t);
+    }
+    
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+};
+
+// Converts the CSV transaction files read by the miners into the binary
+// database format they can map directly
+class DatabaseConverter {
+private:
+    vector<vector<uint32_t>> transactions;  // Distinct transactions
+    vector<int> transaction_weights;        // Multiplicity of each distinct transaction
+    size_t total_transactions;              // Transactions in the file, duplicates included
+    vector<string> item_names;              // Item dictionary: item ID -> item name
+    
+    // Write one section at its aligned offset
+    void writeSection(ofstream& out, uint64_t offset, const void* data, size_t bytes) {
+        static const char padding[8] = {0};
+        uint64_t position = out.tellp();
+        out.write(padding, offset - position);
+        out.write((const char*)data, bytes);
+    }
+    
+public:
+    DatabaseConverter() : total_transactions(0) {}
+    
+    // Read transactions from a CSV file, using the same rules as the miners
+    bool loadTransactions(const string& filename) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            return false;
+        }
+        
+        string line;
+        transactions.clear();
+        unordered_map<string, uint32_t> item_ids;
+        
+        while (getline(file, line)) {
+            if (line.empty()) continue;
+            
+            vector<uint32_t> transaction;
+            stringstream ss(line);
+            string item;
+            
+            while (getline(ss, item, ',')) {
+                // Trim whitespace
+                item.erase(0, item.find_first_not_of(" \t"));
+                item.erase(item.find_last_not_of(" \t") + 1);
+                
+                if (!item.empty() && item != "-1") {
+                    auto inserted = item_ids.insert(make_pair(item, (uint32_t)item_ids.size()));
+                    transaction.push_back(inserted.first->second);
+                }
+            }
+            
+            if (!transaction.empty()) {
+                transactions.push_back(transaction);
+            }
+        }
+        
+        file.close();
+        total_transactions = transactions.size();
+        buildItemDictionary(item_ids);
+        collapseDuplicateTransactions();
+        return true;
+    }
+    
+    // Renumber item IDs in name order so integer itemsets sort like string itemsets
+    void buildItemDictionary(const unordered_map<string, uint32_t>& item_ids) {
+        vector<string> names(item_ids.size());
+        for (const auto& pair : item_ids) {
+            names[pair.second] = pair.first;
+        }
+        
+        vector<uint32_t> order(names.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return names[a] < names[b];
+        });
+        
+        vector<uint32_t> new_ids(names.size());
+        item_names.resize(names.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            new_ids[order[i]] = i;
+            item_names[i] = names[order[i]];
+        }
+        
+        // Rewrite transactions as sorted sets of the final IDs
+        for (auto& transaction : transactions) {
+            for (uint32_t& item : transaction) {
+                item = new_ids[item];
+            }
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        }
+    }
+    
+    // Collapse identical sorted transactions into one transaction with a multiplicity
+    void collapseDuplicateTransactions() {
+        sort(transactions.begin(), transactions.end());
+        transaction_weights.clear();
+        
+        size_t distinct = 0;
+        for (size_t i = 0; i < transactions.size(); i++) {
+            if (distinct > 0 && transactions[i] == transactions[distinct - 1]) {
+                transaction_weights.back()++;
+                continue;
+            }
+            if (i != distinct) {
+                transactions[distinct].swap(transactions[i]);
+            }
+            transaction_weights.push_back(1);
+            distinct++;
+        }
+        transactions.resize(distinct);
+    }
+    
+    // Write the dictionary and transactions in the binary database format
+    bool writeBinaryDatabase(const string& filename) {
+        ofstream out(filename, ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            cerr << "Error: Cannot create file " << filename << endl;
+            return false;
+        }
+        
+        vector<uint64_t> name_offsets(1, 0);
+        string names;
+        for (const string& name : item_names) {
+            names += name;
+            name_offsets.push_back(names.size());
+        }
+        
+        vector<uint64_t> offsets(1, 0);
+        vector<uint32_t> weights;
+        vector<uint32_t> items;
+        for (size_t t = 0; t < transactions.size(); t++) {
+            items.insert(items.end(), transactions[t].begin(), transactions[t].end());
+            offsets.push_back(items.size());
+            weights.push_back(transaction_weights[t]);
+        }
+        
+        BinaryDatabaseHeader header;
+        memcpy(header.magic, "APRIODB1", sizeof(header.magic));
+        header.item_count = item_names.size();
+        header.transaction_count = transactions.size();
+        header.total_transactions = total_transactions;
+        header.item_entries = items.size();
+        header.names_bytes = names.size();
+        BinaryDatabaseLayout layout(header);
+        
+        out.write((const char*)&header, sizeof(header));
+        writeSection(out, layout.name_offsets, name_offsets.data(), name_offsets.size() * sizeof(uint64_t));
+        writeSection(out, layout.names, names.data(), names.size());
+        writeSection(out, layout.offsets, offsets.data(), offsets.size() * sizeof(uint64_t));
+        writeSection(out, layout.weights, weights.data(), weights.size() * sizeof(uint32_t));
+        writeSection(out, layout.items, items.data(), items.size() * sizeof(uint32_t));
+        out.close();
+        
+        if (!out) {
+            cerr << "Error: Failed writing " << filename << endl;
+            return false;
+        }
+        
+        cout << "Wrote " << total_transactions << " transactions (" << transactions.size()
+             << " distinct, " << item_names.size() << " items) to " << filename << endl;
+        return true;
+    }
+};
+
+int main() {
+    string input_filename;
+    string output_filename;
+    
+    cout << "=== CSV to Binary Transaction Database Converter ===" << endl;
+    cout << "Enter CSV data filename: ";
+    cin >> input_filename;
+    
+    cout << "Enter output filename: ";
+    cin >> output_filename;
+    
+    auto start = high_resolution_clock::now();
+    
+    DatabaseConverter converter;
+    if (!converter.loadTransactions(input_filename)) {
+        return 1;
+    }
+    if (!converter.writeBinaryDatabase(output_filename)) {
+        return 1;
+    }
+    
+    auto end = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(end - start);
+    cout << "Conversion time: " << duration.count() << " ms" << endl;
+    
+    return 0;
+}
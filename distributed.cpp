@@ -4,101 +4,721 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <mpi.h>
+#include <omp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_BITMAP_KERNELS 1
+#endif
 
 using namespace std;
 using namespace std::chrono;
 
+// Itemset widths with specialized join, subset test and hashing; wider levels use the
+// generic code, written as the W = 0 instantiation that reads the width at run time
+const size_t MAX_FIXED_WIDTH = 8;
+
+// Compare two itemsets of W items, or of `width` items when W is 0. With W known at
+// compile time the loop unrolls and the comparison has no branches.
+template <size_t W>
+static inline bool sameItems(const uint32_t* a, const uint32_t* b, size_t width) {
+    uint32_t difference = 0;
+    for (size_t i = 0; i < (W ? W : width); i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+// FNV-1a hash over the item IDs of an itemset
+struct ItemsetHash {
+    // W items, or `width` items when W is 0
+    template <size_t W>
+    size_t hashItems(const uint32_t* items, size_t width) const {
+        size_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < (W ? W : width); i++) {
+            hash ^= items[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+    
+    size_t operator()(const uint32_t* items, size_t width) const {
+        return hashItems<0>(items, width);
+    }
+};
+
+// All itemsets of one size with their counts. The item IDs of every itemset sit back
+// to back in one array, which serves as the level's arena: a level is moved from stage
+// to stage and its memory is released in one step. Lookups go through an
+// open-addressing hash index that is built on demand.
+class ItemsetStore {
+private:
+    size_t width;            // Items per itemset
+    vector<uint32_t> items;  // `width` item IDs per itemset
+    vector<int> counts;
+    vector<uint32_t> slots;  // Hash index: itemset position + 1, or 0 for an empty slot
+    
+public:
+    explicit ItemsetStore(size_t itemset_width = 0) : width(itemset_width) {}
+    
+    size_t size() const { return counts.size(); }
+    bool empty() const { return counts.empty(); }
+    size_t itemsetWidth() const { return width; }
+    const uint32_t* itemset(size_t i) const { return items.data() + i * width; }
+    int count(size_t i) const { return counts[i]; }
+    int* countData() { return counts.data(); }
+    
+    void reserve(size_t itemset_count) {
+        items.reserve(itemset_count * width);
+        counts.reserve(itemset_count);
+    }
+    
+    void append(const uint32_t* itemset, int count) {
+        items.insert(items.end(), itemset, itemset + width);
+        counts.push_back(count);
+    }
+    
+    // Make room for itemset_count itemsets, to be filled with set() from any thread
+    void resize(size_t itemset_count) {
+        items.resize(itemset_count * width);
+        counts.resize(itemset_count);
+    }
+    
+    void set(size_t i, const uint32_t* itemset, int count) {
+        copy(itemset, itemset + width, items.begin() + i * width);
+        counts[i] = count;
+    }
+    
+    // Append the itemsets of another store of the same width
+    void appendAll(const ItemsetStore& other) {
+        items.insert(items.end(), other.items.begin(), other.items.end());
+        counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+    }
+    
+    // Keep the itemsets counted at least min_count times, compacting in place
+    void retainAtLeast(int min_count) {
+        size_t kept = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] < min_count) continue;
+            if (kept != i) {
+                copy(items.begin() + i * width, items.begin() + (i + 1) * width, items.begin() + kept * width);
+                counts[kept] = counts[i];
+            }
+            kept++;
+        }
+        items.resize(kept * width);
+        counts.resize(kept);
+        slots.clear();
+    }
+    
+    // Put the itemsets in lexicographic order
+    void sortItemsets() {
+        vector<uint32_t> order(size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return lexicographical_compare(itemset(a), itemset(a) + width, itemset(b), itemset(b) + width);
+        });
+        
+        ItemsetStore sorted(width);
+        sorted.reserve(size());
+        for (uint32_t i : order) {
+            sorted.append(itemset(i), counts[i]);
+        }
+        swap(sorted);
+    }
+    
+    // Index every itemset in a table of at least twice as many slots, probed linearly
+    void buildIndex() {
+        size_t capacity = 16;
+        while (capacity < 2 * size()) capacity *= 2;
+        slots.assign(capacity, 0);
+        
+        ItemsetHash hasher;
+        for (size_t i = 0; i < size(); i++) {
+            size_t slot = hasher(itemset(i), width) & (capacity - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = i + 1;
+        }
+    }
+    
+    // Position of an itemset of this width, or -1; needs buildIndex(). W, when not 0,
+    // must equal the width and lets hashing and comparison unroll.
+    template <size_t W = 0>
+    long long find(const uint32_t* wanted) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = ItemsetHash().hashItems<W>(wanted, width) & mask;
+        while (slots[slot] != 0) {
+            size_t i = slots[slot] - 1;
+            if (sameItems<W>(wanted, itemset(i), width)) return i;
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+    
+    void swap(ItemsetStore& other) {
+        std::swap(width, other.width);
+        items.swap(other.items);
+        counts.swap(other.counts);
+        slots.swap(other.slots);
+    }
+    
+    // Add the itemsets to the mixed-size result map
+    void addTo(map<vector<uint32_t>, int>& itemsets) const {
+        for (size_t i = 0; i < size(); i++) {
+            itemsets.emplace_hint(itemsets.end(), vector<uint32_t>(itemset(i), itemset(i) + width), counts[i]);
+        }
+    }
+};
+
+// Header of the binary transaction database written by convert. The header is
+// followed by the item dictionary and the distinct transactions in CSR form,
+// with every section starting on an 8-byte boundary.
+struct BinaryDatabaseHeader {
+    char magic[8];                // "APRIODB1"
+    uint64_t item_count;
+    uint64_t transaction_count;   // Distinct transactions
+    uint64_t total_transactions;  // Transactions in the source file, duplicates included
+    uint64_t item_entries;        // Length of the items section
+    uint64_t names_bytes;
+};
+
+// Byte offsets of the sections that follow the header
+struct BinaryDatabaseLayout {
+    uint64_t name_offsets;  // uint64_t[item_count + 1] into names
+    uint64_t names;         // char[names_bytes], item names in ID order
+    uint64_t offsets;       // uint64_t[transaction_count + 1] into items
+    uint64_t weights;       // uint32_t[transaction_count]
+    uint64_t items;         // uint32_t[item_entries], sorted item IDs per transaction
+    uint64_t file_size;
+    
+    BinaryDatabaseLayout(const BinaryDatabaseHeader& header) {
+        name_offsets = align(sizeof(BinaryDatabaseHeader));
+        names = align(name_offsets + (header.item_count + 1) * sizeof(uint64_t));
+        offsets = align(names + header.names_bytes);
+        weights = align(offsets + (header.transaction_count + 1) * sizeof(uint64_t));
+        items = align(weights + header.transaction_count * sizeof(uint32_t));
+        file_size = items + header.item_entries * sizeof(uint32_t);
+    }
+    
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+};
+
+// Level-2 pairs are counted in triangular matrices, one per thread plus the reduced
+// one, while they have at most this many entries together
+const size_t MAX_PAIR_MATRIX_ENTRIES = size_t(1) << 24;
+
+// Estimated bytes held per candidate of a level besides its item IDs, which are held
+// twice while the per-thread joins are gathered: its local and its global count
+const size_t CANDIDATE_COUNT_BYTES = 2 * sizeof(int);
+
+// Count distribution splits a level's candidates into at most this many chunks of at
+// least this many candidates, so each chunk's reduction overlaps counting the next
+const size_t MAX_PIPELINE_CHUNKS = 8;
+const size_t MIN_PIPELINE_CHUNK_CANDIDATES = 2048;
+
+// Working transactions are redistributed when the busiest process has this many times
+// the mean estimated work, or, with timing migration, the mean measured counting time
+const double LOAD_IMBALANCE_TOLERANCE = 1.25;
+
+// Bytes read at a time past the end of a process's input range to finish its last line
+const size_t READ_EXTENSION_BYTES = 64 * 1024;
+
+// Subset kernels over item bitmaps: add the weight to counts[c] for every candidate
+// bitmap contained in the transaction bitmap. Candidates are stored back to back,
+// `words` 64-bit words each.
+typedef void (*BitmapKernel)(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts);
+
+static void countBitmapsScalar(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * words;
+        uint64_t missing = 0;
+        for (size_t w = 0; w < words; w++) {
+            missing |= candidate[w] & ~transaction[w];
+        }
+        if (missing == 0) counts[c] += weight;
+    }
+}
+
+#ifdef HAVE_X86_BITMAP_KERNELS
+// testc is set when no candidate bit is missing from the transaction
+__attribute__((target("avx2")))
+static void countBitmapsAVX2(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts) {
+    __m256i low = _mm256_loadu_si256((const __m256i*)transaction);
+    if (words == 4) {
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m256i candidate = _mm256_loadu_si256((const __m256i*)(candidates + c * 4));
+            if (_mm256_testc_si256(low, candidate)) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m256i high = _mm256_loadu_si256((const __m256i*)(transaction + 4));
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * 8;
+        if (_mm256_testc_si256(low, _mm256_loadu_si256((const __m256i*)candidate)) &
+            _mm256_testc_si256(high, _mm256_loadu_si256((const __m256i*)(candidate + 4)))) {
+            counts[c] += weight;
+        }
+    }
+}
+
+// 512-bit universes test one candidate per instruction, 256-bit universes two
+__attribute__((target("avx512f")))
+static void countBitmapsAVX512(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    if (words == 8) {
+        __m512i bits = _mm512_loadu_si512(transaction);
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 8));
+            if (_mm512_test_epi64_mask(missing, missing) == 0) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m512i bits = _mm512_broadcast_i64x4(_mm256_loadu_si256((const __m256i*)transaction));
+    size_t c = 0;
+    for (; c + 2 <= candidate_count; c += 2) {
+        __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 4));
+        __mmask8 mask = _mm512_test_epi64_mask(missing, missing);
+        if ((mask & 0x0F) == 0) counts[c] += weight;
+        if ((mask & 0xF0) == 0) counts[c + 1] += weight;
+    }
+    countBitmapsScalar(candidates + c * 4, candidate_count - c, 4, transaction, weight, counts + c);
+}
+#endif
+
+// Pick the widest kernel the running CPU supports
+static BitmapKernel selectBitmapKernel() {
+#ifdef HAVE_X86_BITMAP_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return countBitmapsAVX512;
+    if (__builtin_cpu_supports("avx2")) return countBitmapsAVX2;
+#endif
+    return countBitmapsScalar;
+}
+
+// Candidates begin..end of one level as fixed-width item bitmaps, usable when there are
+// at most 1024 candidates spanning at most 512 distinct items. Each transaction is turned
+// into a bitmap once and tested against every candidate with a few vector instructions.
+class BitmapCounter {
+private:
+    vector<int> item_bit;             // Bit of each item, -1 if no candidate uses it
+    vector<uint64_t> candidate_bits;  // `words` words per candidate, back to back
+    size_t candidate_count;
+    size_t words;                     // 4 (256 bits) or 8 (512 bits); 0 if the bitmaps are not used
+    size_t depth;
+    BitmapKernel kernel;
+    
+public:
+    BitmapCounter(const ItemsetStore& candidates, size_t begin, size_t end, size_t item_count)
+        : item_bit(item_count, -1), candidate_count(end - begin), words(0),
+          depth(candidates.itemsetWidth()), kernel(selectBitmapKernel()) {
+        int universe = 0;
+        for (size_t c = begin; c < end; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                uint32_t item = candidates.itemset(c)[i];
+                if (item_bit[item] < 0) item_bit[item] = universe++;
+            }
+        }
+        // Every transaction is tested against every candidate, so beyond about a thousand
+        // candidates the trie, which only visits candidates sharing a prefix, is faster
+        if (universe > 512 || candidate_count > 1024) return;
+        
+        words = universe <= 256 ? 4 : 8;
+        candidate_bits.assign(candidate_count * words, 0);
+        for (size_t c = 0; c < candidate_count; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                int bit = item_bit[candidates.itemset(begin + c)[i]];
+                candidate_bits[c * words + bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+    }
+    
+    bool usable() const {
+        return words != 0;
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (candidate_count == 0 || transaction.size() < depth) return;
+        
+        uint64_t bits[8] = {0};
+        size_t present = 0;
+        for (uint32_t item : transaction) {
+            int bit = item_bit[item];
+            if (bit < 0) continue;
+            bits[bit / 64] |= uint64_t(1) << (bit % 64);
+            present++;
+        }
+        
+        if (present >= depth) {
+            kernel(candidate_bits.data(), candidate_count, words, bits, weight, counts.data());
+        }
+    }
+};
+
+// Prefix trie over the candidates of one level. Each transaction walks the
+// trie once and increments only the candidates it contains.
+class CandidateTrie {
+private:
+    struct Node {
+        vector<uint32_t> items;  // Sorted child items
+        vector<int> children;    // Child node index, or candidate index at the last level
+    };
+    
+    vector<Node> nodes;
+    size_t depth;
+    
+    void countNode(int node, const vector<uint32_t>& transaction, size_t start,
+                   size_t level, int weight, vector<int>& counts) const {
+        const Node& current = nodes[node];
+        size_t remaining = depth - level - 1;
+        size_t last = transaction.size() - remaining;
+        size_t child = 0;
+        
+        for (size_t t = start; t < last; t++) {
+            auto it = lower_bound(current.items.begin() + child, current.items.end(), transaction[t]);
+            if (it == current.items.end()) break;
+            
+            child = it - current.items.begin();
+            if (*it == transaction[t]) {
+                if (remaining == 0) {
+                    counts[current.children[child]] += weight;
+                } else {
+                    countNode(current.children[child], transaction, t + 1, level + 1, weight, counts);
+                }
+                child++;
+            }
+        }
+    }
+    
+public:
+    // Candidates begin..end, in sorted order; leaves hold the candidate index minus begin
+    CandidateTrie(const ItemsetStore& candidates, size_t begin, size_t end)
+        : nodes(1), depth(begin < end ? candidates.itemsetWidth() : 0) {
+        for (size_t c = 0; c < end - begin; c++) {
+            int node = 0;
+            for (size_t level = 0; level < depth; level++) {
+                uint32_t item = candidates.itemset(begin + c)[level];
+                bool leaf = (level + 1 == depth);
+                
+                // Sorted insertion means a shared prefix is always the last child
+                if (nodes[node].items.empty() || nodes[node].items.back() != item) {
+                    int target = leaf ? (int)c : (int)nodes.size();
+                    nodes[node].items.push_back(item);
+                    nodes[node].children.push_back(target);
+                    if (!leaf) nodes.push_back(Node());
+                }
+                node = nodes[node].children.back();
+            }
+        }
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (depth == 0 || transaction.size() < depth) return;
+        countNode(0, transaction, 0, 0, weight, counts);
+    }
+};
+
+// FP-tree: transactions are inserted with their items in a fixed header order,
+// so transactions sharing a prefix share a path of counted nodes
+class FPTree {
+private:
+    struct Node {
+        uint32_t item;
+        int count;
+        int parent;
+        int first_child;
+        int next_sibling;
+        int next_same_item;  // Next node in the header chain of this item
+    };
+    
+    struct HeaderEntry {
+        uint32_t item;
+        int support;
+        int first_node;
+    };
+    
+    vector<Node> nodes;                   // Node 0 is the root
+    vector<HeaderEntry> header;           // Frequent items in tree order
+    unordered_map<uint32_t, int> header_index;
+    int min_support;
+    
+public:
+    FPTree(int min_sup) : min_support(min_sup) {
+        Node root = {0, 0, -1, -1, -1, -1};
+        nodes.push_back(root);
+    }
+    
+    // Fix the tree order; items missing from ordered_items are dropped on insert
+    void setHeader(const vector<pair<uint32_t, int>>& ordered_items) {
+        header.clear();
+        header_index.clear();
+        for (const auto& pair : ordered_items) {
+            header_index[pair.first] = header.size();
+            HeaderEntry entry = {pair.first, pair.second, -1};
+            header.push_back(entry);
+        }
+    }
+    
+    // Order (item, support) pairs by descending support, breaking ties by item ID
+    static void sortBySupport(vector<pair<uint32_t, int>>& items) {
+        sort(items.begin(), items.end(), [](const pair<uint32_t, int>& a, const pair<uint32_t, int>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+    
+    // Insert a transaction with the given multiplicity
+    void insert(const vector<uint32_t>& transaction, int count) {
+        vector<int> path;
+        for (uint32_t item : transaction) {
+            auto it = header_index.find(item);
+            if (it != header_index.end()) {
+                path.push_back(it->second);
+            }
+        }
+        sort(path.begin(), path.end());
+        
+        int node = 0;
+        for (int h : path) {
+            int child = nodes[node].first_child;
+            while (child != -1 && nodes[child].item != header[h].item) {
+                child = nodes[child].next_sibling;
+            }
+            
+            if (child == -1) {
+                child = nodes.size();
+                Node created = {header[h].item, 0, node, -1, nodes[node].first_child, header[h].first_node};
+                nodes.push_back(created);
+                nodes[node].first_child = child;
+                header[h].first_node = child;
+            }
+            
+            nodes[child].count += count;
+            node = child;
+        }
+    }
+    
+    size_t headerSize() const {
+        return header.size();
+    }
+    
+    uint32_t headerItem(size_t h) const {
+        return header[h].item;
+    }
+    
+    // Mine every frequent itemset that ends with header item h, extended by suffix
+    void mineItem(size_t h, vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        suffix.push_back(header[h].item);
+        vector<uint32_t> itemset = suffix;
+        sort(itemset.begin(), itemset.end());
+        results[itemset] = header[h].support;
+        
+        // Conditional pattern base: the path above every node of this item
+        vector<pair<vector<uint32_t>, int>> pattern_base;
+        unordered_map<uint32_t, int> conditional_counts;
+        for (int n = header[h].first_node; n != -1; n = nodes[n].next_same_item) {
+            vector<uint32_t> path;
+            for (int p = nodes[n].parent; p != 0; p = nodes[p].parent) {
+                path.push_back(nodes[p].item);
+                conditional_counts[nodes[p].item] += nodes[n].count;
+            }
+            if (!path.empty()) {
+                pattern_base.push_back(make_pair(path, nodes[n].count));
+            }
+        }
+        
+        vector<pair<uint32_t, int>> conditional_items;
+        for (const auto& pair : conditional_counts) {
+            if (pair.second >= min_support) {
+                conditional_items.push_back(pair);
+            }
+        }
+        
+        if (!conditional_items.empty()) {
+            sortBySupport(conditional_items);
+            FPTree conditional(min_support);
+            conditional.setHeader(conditional_items);
+            for (const auto& pattern : pattern_base) {
+                conditional.insert(pattern.first, pattern.second);
+            }
+            conditional.mine(suffix, results);
+        }
+        
+        suffix.pop_back();
+    }
+    
+    // Mine the whole tree, least frequent header items first
+    void mine(vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        for (size_t h = header.size(); h-- > 0;) {
+            mineItem(h, suffix, results);
+        }
+    }
+};
+
 class DistributedApriori {
 private:
     int min_support;
-    vector<vector<string>> local_transactions;
-    map<vector<string>, int> frequent_itemsets;
+    vector<vector<uint32_t>> local_transactions;  // Distinct transactions held by this process
+    vector<int> local_weights;                    // Multiplicity of each local transaction
+    vector<string> item_names;                    // Item dictionary: item ID -> item name
+    map<vector<uint32_t>, int> frequent_itemsets;
+    size_t candidate_budget;                      // Candidate bytes per process before a level switches to candidate distribution
     int rank, size;
+    int num_threads;                              // OpenMP threads per process; only the master thread calls MPI
+    bool timing_migration;                        // Also rebalance when measured counting times diverge
+    double counting_time;                         // Local counting seconds since the last balance check
     
-    // Serialize itemset for MPI communication
-    string serializeItemset(const vector<string>& itemset) {
-        string result;
-        for (size_t i = 0; i < itemset.size(); i++) {
-            result += itemset[i];
-            if (i < itemset.size() - 1) result += ",";
+    // Collapse identical sorted transactions into one transaction with a multiplicity
+    void collapseDuplicateTransactions(vector<vector<uint32_t>>& transactions, vector<int>& weights) {
+        sort(transactions.begin(), transactions.end());
+        weights.clear();
+        
+        size_t distinct = 0;
+        for (size_t i = 0; i < transactions.size(); i++) {
+            if (distinct > 0 && transactions[i] == transactions[distinct - 1]) {
+                weights.back()++;
+                continue;
+            }
+            if (i != distinct) {
+                transactions[distinct].swap(transactions[i]);
+            }
+            weights.push_back(1);
+            distinct++;
         }
-        return result;
+        transactions.resize(distinct);
     }
     
-    // Deserialize itemset from string
-    vector<string> deserializeItemset(const string& str) {
-        vector<string> itemset;
-        stringstream ss(str);
-        string item;
-        
-        while (getline(ss, item, ',')) {
-            // Trim whitespace
-            item.erase(0, item.find_first_not_of(" \t"));
-            item.erase(item.find_last_not_of(" \t") + 1);
-            if (!item.empty()) {
-                itemset.push_back(item);
+    // Broadcast the item dictionary from master so every process shares the same IDs
+    void broadcastItemDictionary() {
+        string names_str;
+        if (rank == 0) {
+            for (const string& name : item_names) {
+                names_str += name;
+                names_str += '\n';
             }
         }
         
-        return itemset;
+        int names_len = names_str.length();
+        MPI_Bcast(&names_len, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        
+        vector<char> buffer(names_str.begin(), names_str.end());
+        buffer.resize(names_len);
+        MPI_Bcast(buffer.data(), names_len, MPI_CHAR, 0, MPI_COMM_WORLD);
+        
+        if (rank != 0) {
+            item_names.clear();
+            size_t begin = 0;
+            for (size_t i = 0; i < buffer.size(); i++) {
+                if (buffer[i] == '\n') {
+                    item_names.push_back(string(buffer.data() + begin, i - begin));
+                    begin = i + 1;
+                }
+            }
+        }
     }
     
 public:
-    DistributedApriori(int min_sup) : min_support(min_sup) {
+    DistributedApriori(int min_sup)
+        : min_support(min_sup), candidate_budget(SIZE_MAX), timing_migration(false), counting_time(0) {
         MPI_Comm_rank(MPI_COMM_WORLD, &rank);
         MPI_Comm_size(MPI_COMM_WORLD, &size);
+        num_threads = omp_get_max_threads();
+    }
+    
+    void setCandidateBudget(size_t bytes) {
+        candidate_budget = bytes;
+    }
+    
+    void setTimingMigration(bool enabled) {
+        timing_migration = enabled;
     }
     
-    // Load and distribute data among processes
+    // Load this process's share of the input. Every process reads its own
+    // newline-aligned byte range of the file with MPI-IO and parses it, and
+    // only the item dictionary passes through master
     void loadAndDistributeData(const string& filename) {
-        vector<vector<string>> all_transactions;
-        
-        // Master process loads all data
+        // Binary databases are mapped slice by slice on every process instead
+        int binary_input = 0;
         if (rank == 0) {
-            ifstream file(filename);
-            if (!file.is_open()) {
-                cerr << "Error: Cannot open file " << filename << endl;
-                MPI_Abort(MPI_COMM_WORLD, 1);
-            }
+            binary_input = isBinaryDatabase(filename);
+        }
+        MPI_Bcast(&binary_input, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (binary_input) {
+            loadBinarySlice(filename);
+            balanceWork(local_transactions, local_weights, 2, false);
+            return;
+        }
+        
+        string text = readLocalRange(filename);
+        
+        // Parse the local lines, encoding every item with a local integer ID
+        unordered_map<string, uint32_t> item_ids;
+        vector<vector<uint32_t>> transactions;
+        const char* line = text.data();
+        const char* end = text.data() + text.size();
+        while (line < end) {
+            const char* line_end = (const char*)memchr(line, '\n', end - line);
+            if (line_end == nullptr) line_end = end;
             
-            string line;
-            while (getline(file, line)) {
-                if (line.empty()) continue;
+            vector<uint32_t> transaction;
+            const char* field = line;
+            while (field < line_end) {
+                const char* field_end = (const char*)memchr(field, ',', line_end - field);
+                if (field_end == nullptr) field_end = line_end;
                 
-                vector<string> transaction;
-                stringstream ss(line);
-                string item;
+                // Trim whitespace
+                const char* first = field;
+                const char* last = field_end;
+                while (first < last && (*first == ' ' || *first == '\t')) first++;
+                while (last > first && (last[-1] == ' ' || last[-1] == '\t')) last--;
                 
-                while (getline(ss, item, ',')) {
-                    // Trim whitespace
-                    item.erase(0, item.find_first_not_of(" \t"));
-                    item.erase(item.find_last_not_of(" \t") + 1);
-                    
-                    if (!item.empty() && item != "-1") {
-                        transaction.push_back(item);
-                    }
+                string item(first, last - first);
+                if (!item.empty() && item != "-1") {
+                    auto inserted = item_ids.insert(make_pair(item, (uint32_t)item_ids.size()));
+                    transaction.push_back(inserted.first->second);
                 }
                 
-                if (!transaction.empty()) {
-                    sort(transaction.begin(), transaction.end());
-                    all_transactions.push_back(transaction);
-                }
+                field = field_end + 1;
             }
-            file.close();
             
-            cout << "Master loaded " << all_transactions.size() << " transactions" << endl;
+            if (!transaction.empty()) {
+                transactions.push_back(transaction);
+            }
+            line = line_end + 1;
         }
+        string().swap(text);
         
-        // Broadcast total number of transactions
-        int total_transactions = all_transactions.size();
-        MPI_Bcast(&total_transactions, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        // Sum the transaction counts of all processes for the empty check and the report
+        long long local_totals[2] = {(long long)transactions.size(), 0};
+        mergeItemDictionaries(item_ids, transactions);
+        collapseDuplicateTransactions(transactions, local_weights);
+        local_totals[1] = transactions.size();
         
-        if (total_transactions == 0) {
+        long long totals[2] = {0, 0};
+        MPI_Allreduce(local_totals, totals, 2, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        
+        if (totals[0] == 0) {
             if (rank == 0) {
                 cerr << "Error: No transactions loaded" << endl;
             }
@@ -106,66 +726,285 @@ public:
             exit(1);
         }
         
-        // Calculate distribution
-        int transactions_per_process = total_transactions / size;
-        int remainder = total_transactions % size;
+        local_transactions.swap(transactions);
+        balanceWork(local_transactions, local_weights, 2, false);
         
-        // Distribute transactions using a simpler approach
-        int local_start = rank * transactions_per_process + min(rank, remainder);
-        int local_count = transactions_per_process + (rank < remainder ? 1 : 0);
+        if (rank == 0) {
+            cout << "Processes loaded " << totals[0] << " transactions ("
+                 << totals[1] << " distinct within each process)" << endl;
+        }
+        cout << "Process " << rank << " holds " << local_transactions.size() << " transactions" << endl;
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+    
+    // Read the lines owned by this process with MPI-IO. The file is split into
+    // equal byte ranges and a process owns every line that starts inside its
+    // range, so it skips the partial line at its start and reads past its end
+    // until the last owned line is complete
+    string readLocalRange(const string& filename) {
+        MPI_File file;
+        if (MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+            if (rank == 0) {
+                cerr << "Error: Cannot open file " << filename << endl;
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        
+        MPI_Offset file_size;
+        MPI_File_get_size(file, &file_size);
+        MPI_Offset range_start = file_size / size * rank;
+        MPI_Offset range_end = (rank == size - 1) ? file_size : file_size / size * (rank + 1);
+        if (range_end == range_start) {
+            MPI_File_close(&file);
+            return string();
+        }
+        
+        // Start one byte early so a range that begins right after a newline keeps its first line
+        MPI_Offset read_start = (range_start > 0) ? range_start - 1 : 0;
+        string text;
+        readBytes(file, read_start, range_end - read_start, text);
+        
+        // The last owned line is the one holding byte range_end - 1
+        size_t last_byte = range_end - read_start - 1;
+        MPI_Offset read_end = range_end;
+        while (read_end < file_size && text.find('\n', last_byte) == string::npos) {
+            MPI_Offset length = min((MPI_Offset)READ_EXTENSION_BYTES, file_size - read_end);
+            readBytes(file, read_end, length, text);
+            read_end += length;
+        }
+        MPI_File_close(&file);
+        
+        size_t last_newline = text.find('\n', last_byte);
+        if (last_newline != string::npos) {
+            text.resize(last_newline + 1);
+        }
+        
+        if (range_start > 0) {
+            // The line straddling range_start belongs to the previous process
+            size_t first_newline = text.find('\n');
+            if (first_newline == string::npos || first_newline >= last_byte) {
+                return string();
+            }
+            text.erase(0, first_newline + 1);
+        }
+        
+        return text;
+    }
+    
+    // Append length bytes read at offset, in pieces small enough for an int count
+    void readBytes(MPI_File file, MPI_Offset offset, MPI_Offset length, string& text) {
+        size_t begin = text.size();
+        text.resize(begin + length);
+        
+        for (MPI_Offset done = 0; done < length;) {
+            int piece = min(length - done, (MPI_Offset)(1 << 30));
+            MPI_File_read_at(file, offset + done, &text[begin + done], piece, MPI_CHAR, MPI_STATUS_IGNORE);
+            done += piece;
+        }
+    }
+    
+    // Merge the item names seen by every process into one dictionary in name order,
+    // so integer itemsets sort like string itemsets, and rewrite the local
+    // transactions as sorted sets of the shared IDs
+    void mergeItemDictionaries(const unordered_map<string, uint32_t>& item_ids,
+                               vector<vector<uint32_t>>& transactions) {
+        vector<string> names(item_ids.size());
+        for (const auto& pair : item_ids) {
+            names[pair.second] = pair.first;
+        }
+        
+        string names_str;
+        for (const string& name : names) {
+            names_str += name;
+            names_str += '\n';
+        }
+        
+        int names_len = names_str.length();
+        vector<int> lengths(size), displacements(size);
+        MPI_Gather(&names_len, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        
+        int total_len = 0;
+        for (int i = 0; i < size; i++) {
+            displacements[i] = total_len;
+            total_len += lengths[i];
+        }
+        
+        vector<char> all_names(rank == 0 ? total_len : 0);
+        MPI_Gatherv(names_str.data(), names_len, MPI_CHAR,
+                    all_names.data(), lengths.data(), displacements.data(), MPI_CHAR,
+                    0, MPI_COMM_WORLD);
         
         if (rank == 0) {
-            // Master process distributes data
-            for (int dest = 1; dest < size; dest++) {
-                int dest_start = dest * transactions_per_process + min(dest, remainder);
-                int dest_count = transactions_per_process + (dest < remainder ? 1 : 0);
-                
-                // Send count first
-                MPI_Send(&dest_count, 1, MPI_INT, dest, 0, MPI_COMM_WORLD);
-                
-                // Send transactions
-                for (int i = 0; i < dest_count; i++) {
-                    string trans_str = serializeItemset(all_transactions[dest_start + i]);
-                    int str_len = trans_str.length();
-                    MPI_Send(&str_len, 1, MPI_INT, dest, 1, MPI_COMM_WORLD);
-                    MPI_Send(trans_str.c_str(), str_len, MPI_CHAR, dest, 2, MPI_COMM_WORLD);
+            item_names.clear();
+            size_t begin = 0;
+            for (size_t i = 0; i < all_names.size(); i++) {
+                if (all_names[i] == '\n') {
+                    item_names.push_back(string(all_names.data() + begin, i - begin));
+                    begin = i + 1;
                 }
             }
-            
-            // Keep local portion for master
-            for (int i = 0; i < local_count; i++) {
-                local_transactions.push_back(all_transactions[i]);
+            sort(item_names.begin(), item_names.end());
+            item_names.erase(unique(item_names.begin(), item_names.end()), item_names.end());
+        }
+        
+        broadcastItemDictionary();
+        
+        vector<uint32_t> new_ids(names.size());
+        for (size_t i = 0; i < names.size(); i++) {
+            new_ids[i] = lower_bound(item_names.begin(), item_names.end(), names[i]) - item_names.begin();
+        }
+        
+        for (auto& transaction : transactions) {
+            for (uint32_t& item : transaction) {
+                item = new_ids[item];
+            }
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        }
+    }
+    
+    // Check whether the file starts with the binary database magic
+    bool isBinaryDatabase(const string& filename) {
+        ifstream file(filename, ios::binary);
+        char magic[8] = {0};
+        file.read(magic, sizeof(magic));
+        return file.gcount() == sizeof(magic) && memcmp(magic, "APRIODB1", sizeof(magic)) == 0;
+    }
+    
+    // Map a byte range of the file, widening it to a page boundary, and return
+    // a pointer to its first byte
+    const char* mapRange(int fd, uint64_t offset, uint64_t length, vector<pair<void*, size_t>>& mappings) {
+        if (length == 0) return nullptr;
+        
+        uint64_t page_size = sysconf(_SC_PAGESIZE);
+        uint64_t page_start = offset - offset % page_size;
+        size_t span = length + (offset - page_start);
+        
+        void* mapped = mmap(nullptr, span, PROT_READ, MAP_PRIVATE, fd, page_start);
+        if (mapped == MAP_FAILED) {
+            cerr << "Error: Process " << rank << " cannot map binary database" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        
+        mappings.push_back(make_pair(mapped, span));
+        return (const char*)mapped + (offset - page_start);
+    }
+    
+    // Every process maps the item dictionary and only its own slice of the
+    // transactions of a binary database written by convert
+    void loadBinarySlice(const string& filename) {
+        // Master checks the header against the file size, so a truncated or corrupt
+        // database stops every process before any slice is mapped
+        BinaryDatabaseHeader header;
+        int status = 0;  // 0 valid, 1 unreadable, 2 truncated
+        if (rank == 0) {
+            int fd = open(filename.c_str(), O_RDONLY);
+            struct stat file_stat;
+            if (fd < 0 || fstat(fd, &file_stat) != 0 ||
+                pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+                status = 1;
+            } else if ((uint64_t)file_stat.st_size < BinaryDatabaseLayout(header).file_size) {
+                status = 2;
             }
-        } else {
-            // Receive data from master
-            MPI_Recv(&local_count, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if (fd >= 0) close(fd);
             
-            for (int i = 0; i < local_count; i++) {
-                int str_len;
-                MPI_Recv(&str_len, 1, MPI_INT, 0, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                
-                char* buffer = new char[str_len + 1];
-                MPI_Recv(buffer, str_len, MPI_CHAR, 0, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                buffer[str_len] = '\0';
-                
-                string trans_str(buffer);
-                local_transactions.push_back(deserializeItemset(trans_str));
-                
-                delete[] buffer;
+            if (status == 1) {
+                cerr << "Error: Cannot open file " << filename << endl;
+            } else if (status == 2) {
+                cerr << "Error: Binary database " << filename << " is truncated" << endl;
+            }
+        }
+        MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (status != 0) {
+            MPI_Finalize();
+            exit(1);
+        }
+        MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, MPI_COMM_WORLD);
+        
+        uint64_t total_transactions = header.transaction_count;
+        if (total_transactions == 0) {
+            if (rank == 0) {
+                cerr << "Error: No transactions loaded" << endl;
             }
+            MPI_Finalize();
+            exit(1);
         }
         
-        cout << "Process " << rank << " received " << local_transactions.size() << " transactions" << endl;
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cerr << "Error: Process " << rank << " cannot open file " << filename << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        
+        BinaryDatabaseLayout layout(header);
+        vector<pair<void*, size_t>> mappings;
+        
+        const uint64_t* name_offsets = (const uint64_t*)mapRange(
+            fd, layout.name_offsets, (header.item_count + 1) * sizeof(uint64_t), mappings);
+        const char* names = mapRange(fd, layout.names, header.names_bytes, mappings);
+        item_names.resize(header.item_count);
+        for (size_t i = 0; i < item_names.size(); i++) {
+            item_names[i].assign(names + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+        }
+        
+        // Same split as the CSV path: distinct transactions divided by count
+        uint64_t transactions_per_process = total_transactions / size;
+        uint64_t remainder = total_transactions % size;
+        uint64_t local_start = rank * transactions_per_process + min((uint64_t)rank, remainder);
+        size_t local_count = transactions_per_process + ((uint64_t)rank < remainder ? 1 : 0);
+        
+        const uint64_t* offsets = (const uint64_t*)mapRange(
+            fd, layout.offsets + local_start * sizeof(uint64_t), (local_count + 1) * sizeof(uint64_t), mappings);
+        const uint32_t* weights = (const uint32_t*)mapRange(
+            fd, layout.weights + local_start * sizeof(uint32_t), local_count * sizeof(uint32_t), mappings);
+        uint64_t first_item = offsets[0];
+        const uint32_t* items = (const uint32_t*)mapRange(
+            fd, layout.items + first_item * sizeof(uint32_t), (offsets[local_count] - first_item) * sizeof(uint32_t), mappings);
+        
+        local_transactions.resize(local_count);
+        local_weights.assign(weights, weights + local_count);
+        for (size_t t = 0; t < local_count; t++) {
+            local_transactions[t].assign(items + (offsets[t] - first_item), items + (offsets[t + 1] - first_item));
+        }
+        
+        for (const auto& mapping : mappings) {
+            munmap(mapping.first, mapping.second);
+        }
+        close(fd);
+        
+        if (rank == 0) {
+            cout << "Binary database holds " << header.total_transactions << " transactions ("
+                 << total_transactions << " distinct)" << endl;
+        }
+        cout << "Process " << rank << " mapped " << local_transactions.size() << " transactions" << endl;
         MPI_Barrier(MPI_COMM_WORLD);
     }
     
-    // Generate local 1-itemsets
-    map<string, int> generateLocalC1() {
-        map<string, int> local_counts;
+    // Generate local 1-itemsets, counting into a dense per-thread array indexed by item ID
+    vector<int> generateLocalC1() {
+        size_t item_count = item_names.size();
+        vector<vector<int>> thread_counts(num_threads, vector<int>(item_count, 0));
+        vector<int> local_counts(item_count, 0);
         
-        for (const auto& transaction : local_transactions) {
-            for (const string& item : transaction) {
-                local_counts[item]++;
+        #pragma omp parallel
+        {
+            vector<int>& counts = thread_counts[omp_get_thread_num()];
+            
+            #pragma omp for schedule(dynamic, 1024)
+            for (int t = 0; t < (int)local_transactions.size(); t++) {
+                for (uint32_t item : local_transactions[t]) {
+                    counts[item] += local_weights[t];
+                }
+            }
+            
+            // Reduce the per-thread arrays, each thread summing a range of items
+            #pragma omp for
+            for (int item = 0; item < (int)item_count; item++) {
+                int total_count = 0;
+                for (int th = 0; th < num_threads; th++) {
+                    total_count += thread_counts[th][item];
+                }
+                local_counts[item] = total_count;
             }
         }
         
@@ -173,173 +1012,569 @@ public:
     }
     
     // Aggregate global 1-itemsets
-    map<vector<string>, int> aggregateC1(const map<string, int>& local_counts) {
-        map<vector<string>, int> global_candidates;
+    ItemsetStore aggregateC1(const vector<int>& local_counts) {
+        ItemsetStore global_candidates(1);
         
-        // Collect all unique items across all processes
-        set<string> local_items;
-        for (const auto& pair : local_counts) {
-            local_items.insert(pair.first);
+        // Every process shares the item dictionary, so the counts of all items are
+        // reduced together in item ID order
+        vector<int> global_counts(local_counts.size(), 0);
+        MPI_Allreduce(local_counts.data(), global_counts.data(), local_counts.size(), MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        
+        for (uint32_t item = 0; item < global_counts.size(); item++) {
+            if (global_counts[item] >= min_support) {
+                global_candidates.append(&item, global_counts[item]);
+            }
         }
         
-        // Convert to vector for MPI operations
-        vector<string> local_items_vec(local_items.begin(), local_items.end());
-        int local_item_count = local_items_vec.size();
+        return global_candidates;
+    }
+    
+    // Generate candidate itemsets from frequent k-itemsets (Apriori-gen), with the
+    // candidate width fixed at compile time for the common small levels. With
+    // owned_only set, only the prefix classes owned by this process are joined.
+    ItemsetStore generateCandidates(ItemsetStore& frequent_k, bool owned_only = false) {
+        static_assert(MAX_FIXED_WIDTH == 8, "the cases below must cover widths 2 to MAX_FIXED_WIDTH");
+        frequent_k.buildIndex();
         
-        // Gather item counts from all processes
-        vector<int> all_item_counts(size);
-        MPI_Allgather(&local_item_count, 1, MPI_INT, all_item_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        switch (frequent_k.itemsetWidth() + 1) {
+            case 2: return joinLevel<2>(frequent_k, owned_only);
+            case 3: return joinLevel<3>(frequent_k, owned_only);
+            case 4: return joinLevel<4>(frequent_k, owned_only);
+            case 5: return joinLevel<5>(frequent_k, owned_only);
+            case 6: return joinLevel<6>(frequent_k, owned_only);
+            case 7: return joinLevel<7>(frequent_k, owned_only);
+            case 8: return joinLevel<8>(frequent_k, owned_only);
+            default: return joinLevel<0>(frequent_k, owned_only);
+        }
+    }
+    
+    // Join the indexed frequent itemsets into candidates of K items, or of any width
+    // when K is 0
+    template <size_t K>
+    ItemsetStore joinLevel(const ItemsetStore& frequent_k, bool owned_only) {
+        size_t k = K ? K - 1 : frequent_k.itemsetWidth();
+        int itemset_count = frequent_k.size();
         
-        // Calculate total items and displacements
-        int total_items = 0;
-        vector<int> displacements(size);
-        for (int i = 0; i < size; i++) {
-            displacements[i] = total_items;
-            total_items += all_item_counts[i];
+        // The frequent itemsets are sorted, so itemsets sharing their first k-1 items
+        // form contiguous prefix classes. Record where the class of each itemset ends
+        // and whether this process joins it.
+        vector<size_t> class_starts = prefixClassStarts<K>(frequent_k);
+        vector<int> owners = owned_only ? assignPrefixClasses(class_starts)
+                                        : vector<int>(class_starts.size() - 1, rank);
+        vector<size_t> class_end(itemset_count);
+        vector<char> joined(itemset_count);
+        for (size_t c = 0; c + 1 < class_starts.size(); c++) {
+            fill(class_end.begin() + class_starts[c], class_end.begin() + class_starts[c + 1], class_starts[c + 1]);
+            fill(joined.begin() + class_starts[c], joined.begin() + class_starts[c + 1], owners[c] == rank);
         }
         
-        // Prepare serialized local items
-        string local_items_str;
-        for (size_t i = 0; i < local_items_vec.size(); i++) {
-            local_items_str += local_items_vec[i];
-            if (i < local_items_vec.size() - 1) local_items_str += ",";
+        // Join pairs of itemsets only within the same prefix class, spreading the
+        // itemsets over threads. Each thread appends to its own store and notes where
+        // the candidates joined from every itemset start there.
+        vector<ItemsetStore> thread_candidates(num_threads, ItemsetStore(k + 1));
+        vector<int> owner(itemset_count);
+        vector<size_t> first(itemset_count);
+        vector<size_t> offset(itemset_count + 1, 0);
+        
+        #pragma omp parallel
+        {
+            int thread_id = omp_get_thread_num();
+            ItemsetStore& local_candidates = thread_candidates[thread_id];
+            
+            array<uint32_t, MAX_FIXED_WIDTH> fixed_candidate;
+            array<uint32_t, MAX_FIXED_WIDTH> fixed_subset;
+            vector<uint32_t> wide_candidate(K ? 0 : k + 1);
+            vector<uint32_t> wide_subset(K ? 0 : k);
+            uint32_t* candidate = K ? fixed_candidate.data() : wide_candidate.data();
+            uint32_t* subset = K ? fixed_subset.data() : wide_subset.data();
+            
+            #pragma omp for schedule(dynamic)
+            for (int i = 0; i < itemset_count; i++) {
+                owner[i] = thread_id;
+                first[i] = local_candidates.size();
+                if (!joined[i]) continue;
+                copy(frequent_k.itemset(i), frequent_k.itemset(i) + (K ? K - 1 : k), candidate);
+                
+                for (size_t j = i + 1; j < class_end[i]; j++) {
+                    candidate[k] = frequent_k.itemset(j)[k - 1];
+                    if (hasFrequentSubsets<K>(candidate, k + 1, frequent_k, subset)) {
+                        local_candidates.append(candidate, 0);
+                    }
+                }
+                offset[i + 1] = local_candidates.size() - first[i];
+            }
         }
         
-        // Calculate string lengths for variable-length allgatherv
-        vector<int> str_lengths(size);
-        int local_str_len = local_items_str.length();
-        MPI_Allgather(&local_str_len, 1, MPI_INT, str_lengths.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        // Gather in itemset order, which is sorted order
+        partial_sum(offset.begin(), offset.end(), offset.begin());
+        ItemsetStore candidates(k + 1);
+        candidates.resize(offset[itemset_count]);
         
-        // Calculate displacements for strings
-        vector<int> str_displacements(size);
-        int total_str_len = 0;
-        for (int i = 0; i < size; i++) {
-            str_displacements[i] = total_str_len;
-            total_str_len += str_lengths[i];
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int i = 0; i < itemset_count; i++) {
+            const ItemsetStore& source = thread_candidates[owner[i]];
+            for (size_t c = 0; c < offset[i + 1] - offset[i]; c++) {
+                candidates.set(offset[i] + c, source.itemset(first[i] + c), 0);
+            }
         }
         
-        // Gather all items as strings
-        char* all_items_buffer = new char[total_str_len + 1];
-        MPI_Allgatherv(local_items_str.c_str(), local_str_len, MPI_CHAR,
-                       all_items_buffer, str_lengths.data(), str_displacements.data(),
-                       MPI_CHAR, MPI_COMM_WORLD);
-        all_items_buffer[total_str_len] = '\0';
+        return candidates;
+    }
+    
+    // Start of every prefix class of the sorted itemsets, followed by itemsets.size(),
+    // for joins into candidates of K items (any width when K is 0)
+    template <size_t K>
+    vector<size_t> prefixClassStarts(const ItemsetStore& itemsets) {
+        vector<size_t> class_starts;
+        size_t class_start = 0;
+        while (class_start < itemsets.size()) {
+            class_starts.push_back(class_start);
+            class_start = prefixClassEnd<K>(itemsets, class_start);
+        }
+        class_starts.push_back(itemsets.size());
+        return class_starts;
+    }
+    
+    // Deal prefix classes out to processes, largest join first, each to the process
+    // with the fewest candidate pairs so far. Every process computes the same owners.
+    vector<int> assignPrefixClasses(const vector<size_t>& class_starts) {
+        size_t class_count = class_starts.size() - 1;
+        vector<size_t> pairs(class_count);
+        vector<size_t> order(class_count);
+        for (size_t c = 0; c < class_count; c++) {
+            size_t n = class_starts[c + 1] - class_starts[c];
+            pairs[c] = n * (n - 1) / 2;
+            order[c] = c;
+        }
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return pairs[a] > pairs[b];
+        });
         
-        // Parse all items and get unique set
-        set<string> all_unique_items;
-        string current_str;
-        for (int i = 0; i < size; i++) {
-            if (str_lengths[i] > 0) {
-                string proc_items(all_items_buffer + str_displacements[i], str_lengths[i]);
-                stringstream ss(proc_items);
-                string item;
-                while (getline(ss, item, ',')) {
-                    if (!item.empty()) {
-                        all_unique_items.insert(item);
-                    }
-                }
+        vector<int> owners(class_count);
+        vector<size_t> load(size, 0);
+        for (size_t c : order) {
+            int owner = min_element(load.begin(), load.end()) - load.begin();
+            owners[c] = owner;
+            load[owner] += pairs[c];
+        }
+        
+        return owners;
+    }
+    
+    // Upper bound on the bytes one process would hold for all candidates of level
+    // k+1 joined from frequent_k, before subset pruning
+    size_t estimateCandidateBytes(const ItemsetStore& frequent_k, size_t k) {
+        size_t pairs = 0;
+        vector<size_t> class_starts = prefixClassStarts<0>(frequent_k);
+        for (size_t c = 0; c + 1 < class_starts.size(); c++) {
+            size_t n = class_starts[c + 1] - class_starts[c];
+            pairs += n * (n - 1) / 2;
+        }
+        
+        return pairs * (CANDIDATE_COUNT_BYTES + 2 * (k + 1) * sizeof(uint32_t));
+    }
+    
+    // Find the end of the prefix class that starts at itemset `start`, for joins
+    // into candidates of K items (any width when K is 0)
+    template <size_t K>
+    size_t prefixClassEnd(const ItemsetStore& itemsets, size_t start) {
+        size_t prefix = itemsets.itemsetWidth() - 1;
+        size_t end = start + 1;
+        while (end < itemsets.size() &&
+               sameItems<K ? K - 2 : 0>(itemsets.itemset(start), itemsets.itemset(end), prefix)) {
+            end++;
+        }
+        return end;
+    }
+    
+    // Check that every k-subset of a (k+1)-candidate of `width` items is frequent
+    // (downward closure), using `subset` as scratch space for k items. The subsets
+    // dropping either of the last two items are the joined itemsets themselves.
+    template <size_t K>
+    bool hasFrequentSubsets(const uint32_t* candidate, size_t width, const ItemsetStore& frequent_k,
+                            uint32_t* subset) {
+        size_t n = K ? K : width;
+        if (n <= 2) return true;
+        
+        for (size_t i = 1; i < n; i++) {
+            subset[i - 1] = candidate[i];
+        }
+        for (size_t skip = 0; skip + 2 < n; skip++) {
+            if (skip > 0) subset[skip - 1] = candidate[skip - 1];
+            if (frequent_k.find<K ? K - 1 : 0>(subset) < 0) {
+                return false;
             }
         }
         
-        delete[] all_items_buffer;
+        return true;
+    }
+    
+    // Count the local support of candidates begin..end into counts, using bitmaps
+    // or a prefix trie built once for the chunk
+    void countLocalSupport(const ItemsetStore& candidates, size_t begin, size_t end,
+                           const vector<vector<uint32_t>>& database,
+                           const vector<int>& weights, int* counts) {
+        // Candidates over a small item universe are tested as bitmaps, others walk the trie
+        BitmapCounter bitmap(candidates, begin, end, item_names.size());
+        CandidateTrie trie(candidates, begin, bitmap.usable() ? begin : end);
         
-        // For each unique item, calculate global support
-        for (const string& item : all_unique_items) {
-            int local_count = (local_counts.find(item) != local_counts.end()) ? local_counts.at(item) : 0;
-            int global_count = 0;
-            
-            MPI_Allreduce(&local_count, &global_count, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        // Each thread tests its transactions against the shared bitmaps or trie
+        vector<vector<int>> thread_counts(num_threads, vector<int>(end - begin, 0));
+        double start = omp_get_wtime();
+        
+        #pragma omp parallel
+        {
+            vector<int>& local_counts = thread_counts[omp_get_thread_num()];
             
-            if (global_count >= min_support) {
-                vector<string> itemset = {item};
-                global_candidates[itemset] = global_count;
+            #pragma omp for schedule(dynamic, 256)
+            for (int t = 0; t < (int)database.size(); t++) {
+                if (bitmap.usable()) {
+                    bitmap.count(database[t], weights[t], local_counts);
+                } else {
+                    trie.count(database[t], weights[t], local_counts);
+                }
             }
         }
         
-        return global_candidates;
+        for (size_t i = 0; i < end - begin; i++) {
+            int total_count = 0;
+            for (int th = 0; th < num_threads; th++) {
+                total_count += thread_counts[th][i];
+            }
+            counts[i] = total_count;
+        }
+        counting_time += omp_get_wtime() - start;
     }
     
-    // Generate candidates from frequent itemsets
-    map<vector<string>, int> generateCandidates(const map<vector<string>, int>& frequent_k) {
-        map<vector<string>, int> candidates;
-        vector<vector<string>> itemsets;
+    // Count global support in place, chunk by chunk. Every process generates the
+    // same candidates in the same order, so their counts line up across processes,
+    // and each chunk is reduced with a non-blocking MPI_Iallreduce while the next
+    // chunk is counted.
+    void countGlobalSupport(ItemsetStore& candidates, const vector<vector<uint32_t>>& database,
+                            const vector<int>& weights) {
+        size_t candidate_count = candidates.size();
+        size_t chunk_count = 1;
+        if (size > 1) {
+            chunk_count = max((size_t)1, min(MAX_PIPELINE_CHUNKS, candidate_count / MIN_PIPELINE_CHUNK_CANDIDATES));
+        }
+        
+        vector<int> local_counts(candidate_count, 0);
+        int* global_counts = candidates.countData();
+        vector<MPI_Request> requests(chunk_count, MPI_REQUEST_NULL);
         
-        for (const auto& pair : frequent_k) {
-            itemsets.push_back(pair.first);
+        for (size_t c = 0; c < chunk_count; c++) {
+            size_t begin = candidate_count * c / chunk_count;
+            size_t end = candidate_count * (c + 1) / chunk_count;
+            
+            countLocalSupport(candidates, begin, end, database, weights, local_counts.data() + begin);
+            MPI_Iallreduce(local_counts.data() + begin, global_counts + begin, end - begin,
+                           MPI_INT, MPI_SUM, MPI_COMM_WORLD, &requests[c]);
+            
+            // Give the reductions already in flight a chance to progress
+            int done;
+            MPI_Testall(c + 1, requests.data(), &done, MPI_STATUSES_IGNORE);
+        }
+        MPI_Waitall(chunk_count, requests.data(), MPI_STATUSES_IGNORE);
+    }
+    
+    // Count the candidates owned by this process against the working transactions
+    // of every process. Each process's block of transactions travels once around
+    // a ring, so the counts come out global without any reduction.
+    void countSupportAroundRing(ItemsetStore& candidates, const vector<vector<uint32_t>>& database,
+                                const vector<int>& weights) {
+        BitmapCounter bitmap(candidates, 0, candidates.size(), item_names.size());
+        CandidateTrie trie(candidates, 0, bitmap.usable() ? 0 : candidates.size());
+        vector<vector<int>> thread_counts(num_threads, vector<int>(candidates.size(), 0));
+        
+        // Flatten the local transactions as length and weight followed by item IDs
+        vector<uint32_t> block;
+        for (size_t t = 0; t < database.size(); t++) {
+            block.push_back(database[t].size());
+            block.push_back(weights[t]);
+            block.insert(block.end(), database[t].begin(), database[t].end());
         }
         
-        for (size_t i = 0; i < itemsets.size(); i++) {
-            for (size_t j = i + 1; j < itemsets.size(); j++) {
-                if (itemsets[i].size() == 0) continue;
+        int next = (rank + 1) % size;
+        int prev = (rank + size - 1) % size;
+        vector<uint32_t> incoming;
+        vector<size_t> starts;
+        for (int step = 0; step < size; step++) {
+            if (!candidates.empty()) {
+                starts.clear();
+                for (size_t pos = 0; pos < block.size(); pos += 2 + block[pos]) {
+                    starts.push_back(pos);
+                }
                 
-                // Check if first k-1 items are the same
-                bool can_join = true;
-                for (size_t k = 0; k < itemsets[i].size() - 1; k++) {
-                    if (itemsets[i][k] != itemsets[j][k]) {
-                        can_join = false;
-                        break;
+                #pragma omp parallel
+                {
+                    vector<int>& counts = thread_counts[omp_get_thread_num()];
+                    vector<uint32_t> transaction;
+                    
+                    #pragma omp for schedule(dynamic, 256)
+                    for (int t = 0; t < (int)starts.size(); t++) {
+                        size_t pos = starts[t];
+                        transaction.assign(block.begin() + pos + 2, block.begin() + pos + 2 + block[pos]);
+                        
+                        if (bitmap.usable()) {
+                            bitmap.count(transaction, block[pos + 1], counts);
+                        } else {
+                            trie.count(transaction, block[pos + 1], counts);
+                        }
                     }
                 }
-                
-                if (can_join) {
-                    vector<string> candidate = itemsets[i];
-                    candidate.push_back(itemsets[j].back());
-                    sort(candidate.begin(), candidate.end());
-                    candidates[candidate] = 0;
+            }
+            if (step == size - 1) break;
+            
+            // Pass the block on and take the previous process's
+            int send_len = block.size();
+            int recv_len = 0;
+            MPI_Sendrecv(&send_len, 1, MPI_INT, next, 0, &recv_len, 1, MPI_INT, prev, 0,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            incoming.resize(recv_len);
+            MPI_Sendrecv(block.data(), send_len, MPI_UINT32_T, next, 1,
+                         incoming.data(), recv_len, MPI_UINT32_T, prev, 1,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            block.swap(incoming);
+        }
+        
+        int* counts = candidates.countData();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            int total_count = 0;
+            for (int th = 0; th < num_threads; th++) {
+                total_count += thread_counts[th][i];
+            }
+            counts[i] = total_count;
+        }
+    }
+    
+    // Count every pair of frequent items in one pass over the local transactions, into
+    // flat upper-triangular per-thread matrices indexed by item rank, and sum the
+    // matrices across processes with a single reduction
+    ItemsetStore countFrequentPairs(const ItemsetStore& frequent_1, const vector<vector<uint32_t>>& database,
+                                    const vector<int>& weights) {
+        vector<uint32_t> items;
+        vector<int> item_rank(item_names.size(), -1);
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            item_rank[frequent_1.itemset(i)[0]] = items.size();
+            items.push_back(frequent_1.itemset(i)[0]);
+        }
+        size_t n = items.size();
+        
+        size_t entries = n * (n - 1) / 2;
+        vector<vector<uint32_t>> thread_matrices(num_threads, vector<uint32_t>(entries, 0));
+        vector<uint32_t> matrix(entries, 0);
+        double start = omp_get_wtime();
+        
+        #pragma omp parallel
+        {
+            vector<uint32_t>& local_matrix = thread_matrices[omp_get_thread_num()];
+            vector<uint32_t> ranks;
+            
+            #pragma omp for schedule(dynamic, 256)
+            for (int t = 0; t < (int)database.size(); t++) {
+                ranks.clear();
+                for (uint32_t item : database[t]) {
+                    if (item_rank[item] >= 0) ranks.push_back(item_rank[item]);
+                }
+                for (size_t a = 0; a < ranks.size(); a++) {
+                    size_t r = ranks[a];
+                    size_t row = pairRowStart(r, n);
+                    for (size_t b = a + 1; b < ranks.size(); b++) {
+                        local_matrix[row + (ranks[b] - r - 1)] += weights[t];
+                    }
+                }
+            }
+            
+            // Reduce the per-thread matrices, each thread summing a range of entries
+            #pragma omp for
+            for (long long i = 0; i < (long long)entries; i++) {
+                uint32_t total_count = 0;
+                for (int th = 0; th < num_threads; th++) {
+                    total_count += thread_matrices[th][i];
                 }
+                matrix[i] = total_count;
             }
         }
+        counting_time += omp_get_wtime() - start;
         
-        return candidates;
+        MPI_Allreduce(MPI_IN_PLACE, matrix.data(), matrix.size(), MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+        
+        return readFrequentPairs(items, matrix);
     }
     
-    // Check if itemset is subset of transaction
-    bool isSubset(const vector<string>& itemset, const vector<string>& transaction) {
-        return includes(transaction.begin(), transaction.end(),
-                       itemset.begin(), itemset.end());
+    // Level 2 uses the pair matrix when there are pairs to count and the per-thread
+    // matrices together with their reduction are small enough, also against the
+    // candidate budget
+    bool pairMatrixFits(size_t frequent_items) {
+        if (frequent_items < 2) return false;
+        size_t entries = frequent_items * (frequent_items - 1) / 2 * (num_threads + 1);
+        return entries <= MAX_PAIR_MATRIX_ENTRIES && entries * sizeof(uint32_t) <= candidate_budget;
     }
     
-    // Count local support for candidates
-    map<vector<string>, int> countLocalSupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> local_support;
-        
-        for (const auto& pair : candidates) {
-            int count = 0;
-            for (const auto& transaction : local_transactions) {
-                if (isSubset(pair.first, transaction)) {
-                    count++;
+    // Offset of row r in the flat upper-triangular matrix over n items; pair (r, c)
+    // with r < c lives at pairRowStart(r, n) + (c - r - 1)
+    size_t pairRowStart(size_t r, size_t n) {
+        return r * (2 * n - r - 1) / 2;
+    }
+    
+    // Read the frequent 2-itemsets out of the pair matrix, in itemset order
+    ItemsetStore readFrequentPairs(const vector<uint32_t>& items, const vector<uint32_t>& matrix) {
+        ItemsetStore frequent_pairs(2);
+        size_t index = 0;
+        for (size_t r = 0; r < items.size(); r++) {
+            for (size_t c = r + 1; c < items.size(); c++, index++) {
+                if ((int)matrix[index] >= min_support) {
+                    uint32_t pair[2] = {items[r], items[c]};
+                    frequent_pairs.append(pair, matrix[index]);
                 }
             }
-            local_support[pair.first] = count;
         }
         
-        return local_support;
+        return frequent_pairs;
+    }
+    
+    // Estimated cost of counting level k over a transaction: its number of k-subsets
+    double estimateWork(size_t length, size_t k) {
+        if (length < k) return 0;
+        double work = 1;
+        for (size_t i = 0; i < k; i++) {
+            work = work * (length - i) / (i + 1);
+        }
+        return work;
+    }
+    
+    // Redistribute the working transactions so every process holds about the same
+    // estimated work for counting level k. Transactions are laid out in process
+    // order and cut where the running total of work crosses each process's share.
+    // Unless forced, nothing moves while the estimated work is already balanced.
+    bool balanceWork(vector<vector<uint32_t>>& working, vector<int>& working_weights, size_t k, bool force) {
+        if (size == 1) return false;
+        
+        vector<double> work(working.size());
+        double local_work = 0;
+        for (size_t t = 0; t < working.size(); t++) {
+            work[t] = estimateWork(working[t].size(), k);
+            local_work += work[t];
+        }
+        
+        double total_work = 0, max_work = 0;
+        MPI_Allreduce(&local_work, &total_work, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(&local_work, &max_work, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if (total_work == 0) return false;
+        if (!force && max_work <= LOAD_IMBALANCE_TOLERANCE * total_work / size) return false;
+        
+        double work_before = 0;
+        MPI_Exscan(&local_work, &work_before, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        if (rank == 0) work_before = 0;
+        
+        // Each transaction goes to the process whose share holds its midpoint, encoded
+        // as length and weight followed by item IDs
+        vector<vector<uint32_t>> outgoing(size);
+        for (size_t t = 0; t < working.size(); t++) {
+            double midpoint = work_before + work[t] / 2;
+            int dest = min(size - 1, (int)(midpoint / total_work * size));
+            outgoing[dest].push_back(working[t].size());
+            outgoing[dest].push_back(working_weights[t]);
+            outgoing[dest].insert(outgoing[dest].end(), working[t].begin(), working[t].end());
+            work_before += work[t];
+        }
+        
+        vector<vector<uint32_t>>().swap(working);
+        working_weights.clear();
+        
+        vector<uint32_t> incoming = exchangeBuffers(outgoing);
+        for (size_t pos = 0; pos < incoming.size();) {
+            uint32_t length = incoming[pos++];
+            working_weights.push_back(incoming[pos++]);
+            working.push_back(vector<uint32_t>(incoming.begin() + pos, incoming.begin() + pos + length));
+            pos += length;
+        }
+        
+        if (rank == 0) {
+            cout << "Balanced transactions by estimated work for level " << k << endl;
+        }
+        return true;
+    }
+    
+    // Whether the local counting times measured since the last check diverge across processes
+    bool countingTimesDiverge() {
+        double total_time = 0, max_time = 0;
+        MPI_Allreduce(&counting_time, &total_time, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(&counting_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        counting_time = 0;
+        
+        bool diverge = max_time > LOAD_IMBALANCE_TOLERANCE * total_time / size;
+        if (diverge && rank == 0) {
+            cout << "Counting times diverged (slowest " << (int)(max_time * 1000) << " ms, mean "
+                 << (int)(total_time * 1000 / size) << " ms)" << endl;
+        }
+        return diverge;
     }
     
-    // Aggregate global support
-    map<vector<string>, int> aggregateSupport(const map<vector<string>, int>& local_support) {
-        map<vector<string>, int> global_support;
+    // Send every process its buffer from outgoing and return the concatenation of
+    // the buffers received from all processes, in process order
+    vector<uint32_t> exchangeBuffers(const vector<vector<uint32_t>>& outgoing) {
+        vector<int> send_counts(size), recv_counts(size), send_displs(size), recv_displs(size);
+        vector<uint32_t> send_buffer;
+        for (int dest = 0; dest < size; dest++) {
+            send_counts[dest] = outgoing[dest].size();
+            send_displs[dest] = send_buffer.size();
+            send_buffer.insert(send_buffer.end(), outgoing[dest].begin(), outgoing[dest].end());
+        }
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
         
-        for (const auto& pair : local_support) {
-            int global_count = 0;
-            MPI_Allreduce(&pair.second, &global_count, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-            global_support[pair.first] = global_count;
+        int total_recv = 0;
+        for (int src = 0; src < size; src++) {
+            recv_displs[src] = total_recv;
+            total_recv += recv_counts[src];
         }
+        vector<uint32_t> recv_buffer(total_recv);
+        MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_UINT32_T,
+                      recv_buffer.data(), recv_counts.data(), recv_displs.data(), MPI_UINT32_T,
+                      MPI_COMM_WORLD);
         
-        return global_support;
+        return recv_buffer;
     }
     
-    // Filter by minimum support
-    map<vector<string>, int> filterBySupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> frequent;
+    // Shrink the working set before counting the next level: drop items that occur
+    // in no candidate, then drop transactions too short to contain a candidate
+    void trimWorkingSet(const ItemsetStore& candidates, size_t min_length,
+                        vector<vector<uint32_t>>& working, vector<int>& working_weights) {
+        vector<char> live_items(item_names.size(), 0);
+        for (size_t c = 0; c < candidates.size(); c++) {
+            for (size_t i = 0; i < candidates.itemsetWidth(); i++) {
+                live_items[candidates.itemset(c)[i]] = 1;
+            }
+        }
         
-        for (const auto& pair : candidates) {
-            if (pair.second >= min_support) {
-                frequent[pair.first] = pair.second;
+        // Filter items of every transaction in parallel
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int t = 0; t < (int)working.size(); t++) {
+            vector<uint32_t>& transaction = working[t];
+            transaction.erase(remove_if(transaction.begin(), transaction.end(),
+                                        [&](uint32_t item) { return !live_items[item]; }),
+                              transaction.end());
+        }
+        
+        // Compact surviving transactions towards the front
+        size_t kept = 0;
+        for (size_t t = 0; t < working.size(); t++) {
+            if (working[t].size() < min_length) continue;
+            if (kept != t) {
+                working[kept].swap(working[t]);
+                working_weights[kept] = working_weights[t];
             }
+            kept++;
         }
         
-        return frequent;
+        working.resize(kept);
+        working_weights.resize(kept);
+    }
+    
+    // Filter candidates by minimum support; the level is moved in and out, not copied
+    ItemsetStore filterBySupport(ItemsetStore candidates) {
+        candidates.retainAtLeast(min_support);
+        return candidates;
     }
     
     void runDistributedApriori() {
@@ -348,6 +1583,7 @@ public:
         if (rank == 0) {
             cout << "\n=== Running Distributed Apriori Algorithm ===" << endl;
             cout << "Number of processes: " << size << endl;
+            cout << "Threads per process: " << num_threads << endl;
             cout << "Minimum support: " << min_support << endl << endl;
         }
         
@@ -364,37 +1600,74 @@ public:
         }
         
         // Store frequent 1-itemsets
-        for (const auto& pair : frequent_k) {
-            frequent_itemsets[pair.first] = pair.second;
-        }
+        frequent_k.addTo(frequent_itemsets);
+        
+        // Local working set scanned by the level loop, trimmed in place as levels progress
+        vector<vector<uint32_t>> working_transactions = local_transactions;
+        vector<int> working_weights = local_weights;
+        
+        // Set when the previous count-distribution level's counting times diverged
+        bool rebalance = false;
+        counting_time = 0;
         
         int k = 1;
         while (!frequent_k.empty()) {
-            // Generate candidates for next level
-            auto candidates = generateCandidates(frequent_k);
-            if (candidates.empty()) break;
-            
-            if (rank == 0) {
-                cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
+            if (estimateCandidateBytes(frequent_k, k) > candidate_budget) {
+                // Candidate distribution: each process generates and counts only the
+                // prefix classes it owns, then the frequent itemsets are shared
+                auto candidates = generateCandidates(frequent_k, true);
+                long long total_candidates = candidates.size();
+                MPI_Allreduce(MPI_IN_PLACE, &total_candidates, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+                if (total_candidates == 0) break;
+                
+                if (rank == 0) {
+                    cout << "Generated " << total_candidates << " candidates for level " << (k+1)
+                         << " (candidate distribution)" << endl;
+                }
+                
+                // Every candidate item occurs in frequent_k, which all processes share
+                trimWorkingSet(frequent_k, k + 1, working_transactions, working_weights);
+                
+                countSupportAroundRing(candidates, working_transactions, working_weights);
+                frequent_k = allgatherItemsets(filterBySupport(move(candidates)));
+            } else if (k == 1 && pairMatrixFits(frequent_k.size())) {
+                // Level 2: count all pairs of frequent items directly instead of
+                // materializing them as candidates
+                if (rank == 0) {
+                    cout << "Generated " << frequent_k.size() * (frequent_k.size() - 1) / 2
+                         << " candidates for level 2 (pair matrix)" << endl;
+                }
+                
+                trimWorkingSet(frequent_k, 2, working_transactions, working_weights);
+                balanceWork(working_transactions, working_weights, 2, rebalance);
+                frequent_k = countFrequentPairs(frequent_k, working_transactions, working_weights);
+                rebalance = timing_migration && countingTimesDiverge();
+            } else {
+                // Generate candidates for next level
+                auto candidates = generateCandidates(frequent_k);
+                if (candidates.empty()) break;
+                
+                if (rank == 0) {
+                    cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
+                }
+                
+                trimWorkingSet(candidates, k + 1, working_transactions, working_weights);
+                balanceWork(working_transactions, working_weights, k + 1, rebalance);
+                
+                // Count support, reducing each chunk of candidates while counting the next
+                countGlobalSupport(candidates, working_transactions, working_weights);
+                rebalance = timing_migration && countingTimesDiverge();
+                
+                // Filter by minimum support
+                frequent_k = filterBySupport(move(candidates));
             }
             
-            // Count local support
-            auto local_support = countLocalSupport(candidates);
-            
-            // Aggregate global support
-            auto global_support = aggregateSupport(local_support);
-            
-            // Filter by minimum support
-            frequent_k = filterBySupport(global_support);
-            
             if (rank == 0) {
                 cout << "Frequent " << (k+1) << "-itemsets: " << frequent_k.size() << endl;
             }
             
             // Store frequent itemsets
-            for (const auto& pair : frequent_k) {
-                frequent_itemsets[pair.first] = pair.second;
-            }
+            frequent_k.addTo(frequent_itemsets);
             
             k++;
         }
@@ -410,17 +1683,201 @@ public:
             
             // Save timing results
             ofstream result("distributed_results.txt", ios::app);
-            result << "Distributed_" << size << "_processes" << endl << duration.count() << endl;
+            result << "Distributed_" << size << "_processes";
+            if (num_threads > 1) result << "_" << num_threads << "_threads";
+            result << endl << duration.count() << endl;
             result.close();
         }
     }
     
+    // Distributed FP-Growth (PFP-style): frequent items are dealt out to owner
+    // ranks, every rank sends each owner the transaction prefixes that end at
+    // the owner's items, and each owner mines its items from its own FP-tree
+    void runDistributedFPGrowth() {
+        auto start = high_resolution_clock::now();
+        
+        if (rank == 0) {
+            cout << "\n=== Running Distributed FP-Growth Algorithm ===" << endl;
+            cout << "Number of processes: " << size << endl;
+            cout << "Minimum support: " << min_support << endl << endl;
+        }
+        
+        MPI_Barrier(MPI_COMM_WORLD);
+        
+        // Global frequent items in tree order; position p is owned by rank p % size
+        auto frequent_1 = aggregateC1(generateLocalC1());
+        vector<pair<uint32_t, int>> frequent_items;
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            frequent_items.push_back(make_pair(frequent_1.itemset(i)[0], frequent_1.count(i)));
+        }
+        FPTree::sortBySupport(frequent_items);
+        
+        vector<int> position(item_names.size(), -1);
+        for (size_t p = 0; p < frequent_items.size(); p++) {
+            position[frequent_items[p].first] = p;
+        }
+        
+        // Each owner gets the longest prefix ending at one of its items, once per
+        // transaction, encoded as length and weight followed by item IDs
+        vector<vector<uint32_t>> outgoing(size);
+        vector<char> sent(size);
+        vector<int> path;
+        for (size_t t = 0; t < local_transactions.size(); t++) {
+            path.clear();
+            for (uint32_t item : local_transactions[t]) {
+                if (position[item] >= 0) path.push_back(position[item]);
+            }
+            sort(path.begin(), path.end());
+            
+            fill(sent.begin(), sent.end(), 0);
+            for (size_t i = path.size(); i-- > 0;) {
+                int owner = path[i] % size;
+                if (sent[owner]) continue;
+                sent[owner] = 1;
+                
+                outgoing[owner].push_back(i + 1);
+                outgoing[owner].push_back(local_weights[t]);
+                for (size_t j = 0; j <= i; j++) {
+                    outgoing[owner].push_back(frequent_items[path[j]].first);
+                }
+            }
+        }
+        
+        // Exchange prefixes between all ranks
+        vector<uint32_t> recv_buffer = exchangeBuffers(outgoing);
+        
+        // Build the local FP-tree in the global item order and mine the owned items
+        FPTree tree(min_support);
+        tree.setHeader(frequent_items);
+        vector<uint32_t> prefix;
+        for (size_t pos = 0; pos < recv_buffer.size();) {
+            uint32_t length = recv_buffer[pos++];
+            int weight = recv_buffer[pos++];
+            prefix.assign(recv_buffer.begin() + pos, recv_buffer.begin() + pos + length);
+            tree.insert(prefix, weight);
+            pos += length;
+        }
+        
+        map<vector<uint32_t>, int> local_results;
+        vector<uint32_t> suffix;
+        for (size_t h = rank; h < tree.headerSize(); h += size) {
+            tree.mineItem(h, suffix, local_results);
+        }
+        
+        gatherResults(local_results);
+        
+        MPI_Barrier(MPI_COMM_WORLD);
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        if (rank == 0) {
+            // Report per-level totals in the same shape as the Apriori run
+            map<size_t, int> level_counts;
+            for (const auto& pair : frequent_itemsets) {
+                level_counts[pair.first.size()]++;
+            }
+            for (const auto& level : level_counts) {
+                cout << "Frequent " << level.first << "-itemsets: " << level.second << endl;
+            }
+            
+            cout << "\nDistributed FP-Growth completed!" << endl;
+            cout << "Total frequent itemsets: " << frequent_itemsets.size() << endl;
+            cout << "Execution time: " << duration.count() << " ms" << endl;
+            
+            // Save timing results
+            ofstream result("distributed_results.txt", ios::app);
+            result << "Distributed_FPGrowth_" << size << "_processes" << endl << duration.count() << endl;
+            result.close();
+        }
+    }
+    
+    // Flatten itemsets as itemset size, item IDs, support
+    vector<uint32_t> flattenItemsets(const map<vector<uint32_t>, int>& itemsets) {
+        vector<uint32_t> buffer;
+        for (const auto& pair : itemsets) {
+            buffer.push_back(pair.first.size());
+            buffer.insert(buffer.end(), pair.first.begin(), pair.first.end());
+            buffer.push_back(pair.second);
+        }
+        return buffer;
+    }
+    
+    void unflattenItemsets(const vector<uint32_t>& buffer, map<vector<uint32_t>, int>& itemsets) {
+        for (size_t pos = 0; pos < buffer.size();) {
+            uint32_t itemset_size = buffer[pos++];
+            vector<uint32_t> itemset(buffer.begin() + pos, buffer.begin() + pos + itemset_size);
+            pos += itemset_size;
+            itemsets[itemset] = buffer[pos++];
+        }
+    }
+    
+    // Collect itemsets mined on every process into frequent_itemsets on master
+    void gatherResults(const map<vector<uint32_t>, int>& local_results) {
+        vector<uint32_t> local_buffer = flattenItemsets(local_results);
+        
+        int local_len = local_buffer.size();
+        vector<int> lengths(size), displacements(size);
+        MPI_Gather(&local_len, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        
+        int total_len = 0;
+        for (int i = 0; i < size; i++) {
+            displacements[i] = total_len;
+            total_len += lengths[i];
+        }
+        
+        vector<uint32_t> all_buffer(rank == 0 ? total_len : 0);
+        MPI_Gatherv(local_buffer.data(), local_len, MPI_UINT32_T,
+                    all_buffer.data(), lengths.data(), displacements.data(), MPI_UINT32_T,
+                    0, MPI_COMM_WORLD);
+        
+        if (rank == 0) {
+            unflattenItemsets(all_buffer, frequent_itemsets);
+        }
+    }
+    
+    // Share the itemsets of one size found on every process with all processes, in
+    // sorted order. Every itemset travels as its item IDs followed by its count.
+    ItemsetStore allgatherItemsets(const ItemsetStore& local_itemsets) {
+        size_t width = local_itemsets.itemsetWidth();
+        vector<uint32_t> local_buffer;
+        local_buffer.reserve(local_itemsets.size() * (width + 1));
+        for (size_t i = 0; i < local_itemsets.size(); i++) {
+            local_buffer.insert(local_buffer.end(), local_itemsets.itemset(i), local_itemsets.itemset(i) + width);
+            local_buffer.push_back(local_itemsets.count(i));
+        }
+        
+        int local_len = local_buffer.size();
+        vector<int> lengths(size), displacements(size);
+        MPI_Allgather(&local_len, 1, MPI_INT, lengths.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        
+        int total_len = 0;
+        for (int i = 0; i < size; i++) {
+            displacements[i] = total_len;
+            total_len += lengths[i];
+        }
+        
+        vector<uint32_t> all_buffer(total_len);
+        MPI_Allgatherv(local_buffer.data(), local_len, MPI_UINT32_T,
+                       all_buffer.data(), lengths.data(), displacements.data(), MPI_UINT32_T,
+                       MPI_COMM_WORLD);
+        
+        ItemsetStore itemsets(width);
+        itemsets.reserve(all_buffer.size() / (width + 1));
+        for (size_t pos = 0; pos < all_buffer.size(); pos += width + 1) {
+            itemsets.append(&all_buffer[pos], all_buffer[pos + width]);
+        }
+        
+        // Each process's itemsets are sorted, but their concatenation is not
+        itemsets.sortItemsets();
+        return itemsets;
+    }
+    
     void printResults() {
         if (rank == 0) {
             cout << "\n=== FREQUENT ITEMSETS ===" << endl;
             
             // Group by size for better readability
-            map<int, vector<pair<vector<string>, int>>> grouped_results;
+            map<int, vector<pair<vector<uint32_t>, int>>> grouped_results;
             
             for (const auto& pair : frequent_itemsets) {
                 grouped_results[pair.first.size()].push_back(pair);
@@ -433,7 +1890,7 @@ public:
                 for (const auto& pair : group.second) {
                     cout << "{ ";
                     for (size_t i = 0; i < pair.first.size(); i++) {
-                        cout << pair.first[i];
+                        cout << item_names[pair.first[i]];
                         if (i < pair.first.size() - 1) cout << ", ";
                     }
                     cout << " } : " << pair.second << endl;
@@ -457,24 +1914,29 @@ public:
         // Run the algorithm
         auto local_c1 = generateLocalC1();
         auto frequent_k = aggregateC1(local_c1);
+        frequent_k.addTo(frequent_itemsets);
         
-        for (const auto& pair : frequent_k) {
-            frequent_itemsets[pair.first] = pair.second;
-        }
+        vector<vector<uint32_t>> working_transactions = local_transactions;
+        vector<int> working_weights = local_weights;
         
         int k = 1;
         while (!frequent_k.empty()) {
-            auto candidates = generateCandidates(frequent_k);
-            if (candidates.empty()) break;
-            
-            auto local_support = countLocalSupport(candidates);
-            auto global_support = aggregateSupport(local_support);
-            frequent_k = filterBySupport(global_support);
-            
-            for (const auto& pair : frequent_k) {
-                frequent_itemsets[pair.first] = pair.second;
+            if (k == 1 && pairMatrixFits(frequent_k.size())) {
+                trimWorkingSet(frequent_k, 2, working_transactions, working_weights);
+                balanceWork(working_transactions, working_weights, 2, false);
+                frequent_k = countFrequentPairs(frequent_k, working_transactions, working_weights);
+            } else {
+                auto candidates = generateCandidates(frequent_k);
+                if (candidates.empty()) break;
+                
+                trimWorkingSet(candidates, k + 1, working_transactions, working_weights);
+                balanceWork(working_transactions, working_weights, k + 1, false);
+                countGlobalSupport(candidates, working_transactions, working_weights);
+                frequent_k = filterBySupport(move(candidates));
             }
             
+            frequent_k.addTo(frequent_itemsets);
+            
             k++;
         }
         
@@ -495,7 +1957,9 @@ public:
 };
 
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    // Threads only compute between MPI calls, which the master thread makes
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -504,8 +1968,12 @@ int main(int argc, char** argv) {
     int min_support;
     string filename;
     int mode;
+    long long budget_mb = -1;
     
     if (rank == 0) {
+        if (provided < MPI_THREAD_FUNNELED) {
+            cerr << "Warning: MPI library does not support funneled threads" << endl;
+        }
         cout << "=== Distributed Apriori Algorithm (MPI) ===" << endl;
         cout << "Enter minimum support count: ";
         cin >> min_support;
@@ -516,12 +1984,23 @@ int main(int argc, char** argv) {
         cout << "Select mode:" << endl;
         cout << "1. Normal run" << endl;
         cout << "2. Performance test" << endl;
+        cout << "3. FP-Growth" << endl;
+        cout << "4. Normal run with a candidate memory budget" << endl;
+        cout << "5. Normal run migrating transactions when counting times diverge" << endl;
         cin >> mode;
+        
+        // Levels whose candidates would exceed the budget on one process use
+        // candidate distribution instead of count distribution
+        if (mode == 4) {
+            cout << "Enter candidate memory budget per process in MB (0 distributes every level): ";
+            cin >> budget_mb;
+        }
     }
     
     // Broadcast parameters to all processes
     MPI_Bcast(&min_support, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&mode, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&budget_mb, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
     
     // Broadcast filename
     char filename_buffer[256];
@@ -543,9 +2022,16 @@ int main(int argc, char** argv) {
     DistributedApriori apriori(min_support);
     apriori.loadAndDistributeData(filename);
     
-    if (mode == 1) {
+    if (mode == 1 || mode == 4 || mode == 5) {
+        if (mode == 4 && budget_mb >= 0) {
+            apriori.setCandidateBudget(budget_mb << 20);
+        }
+        apriori.setTimingMigration(mode == 5);
         apriori.runDistributedApriori();
         apriori.printResults();
+    } else if (mode == 3) {
+        apriori.runDistributedFPGrowth();
+        apriori.printResults();
     } else {
         apriori.performanceTest();
     }
@@ -1,25 +1,631 @@
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <numeric>
+#include <set>
 #include <omp.h>
-#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_BITMAP_KERNELS 1
+#endif
 
 using namespace std;
 using namespace std::chrono;
 
+// Itemset widths with specialized join, subset test and hashing; wider levels use the
+// generic code, written as the W = 0 instantiation that reads the width at run time
+const size_t MAX_FIXED_WIDTH = 8;
+
+// Compare two itemsets of W items, or of `width` items when W is 0. With W known at
+// compile time the loop unrolls and the comparison has no branches.
+template <size_t W>
+static inline bool sameItems(const uint32_t* a, const uint32_t* b, size_t width) {
+    uint32_t difference = 0;
+    for (size_t i = 0; i < (W ? W : width); i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+// FNV-1a hash over the item IDs of an itemset
+struct ItemsetHash {
+    // W items, or `width` items when W is 0
+    template <size_t W>
+    size_t hashItems(const uint32_t* items, size_t width) const {
+        size_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < (W ? W : width); i++) {
+            hash ^= items[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+    
+    size_t operator()(const uint32_t* items, size_t width) const {
+        return hashItems<0>(items, width);
+    }
+    
+    size_t operator()(const vector<uint32_t>& itemset) const {
+        return hashItems<0>(itemset.data(), itemset.size());
+    }
+};
+
+// All itemsets of one size with their counts. The item IDs of every itemset sit back
+// to back in one array, which serves as the level's arena: a level is moved from stage
+// to stage and its memory is released in one step. Lookups go through an
+// open-addressing hash index that is built on demand.
+class ItemsetStore {
+private:
+    size_t width;            // Items per itemset
+    vector<uint32_t> items;  // `width` item IDs per itemset
+    vector<int> counts;
+    vector<uint32_t> slots;  // Hash index: itemset position + 1, or 0 for an empty slot
+    
+public:
+    explicit ItemsetStore(size_t itemset_width = 0) : width(itemset_width) {}
+    
+    size_t size() const { return counts.size(); }
+    bool empty() const { return counts.empty(); }
+    size_t itemsetWidth() const { return width; }
+    const uint32_t* itemset(size_t i) const { return items.data() + i * width; }
+    int count(size_t i) const { return counts[i]; }
+    int* countData() { return counts.data(); }
+    
+    void reserve(size_t itemset_count) {
+        items.reserve(itemset_count * width);
+        counts.reserve(itemset_count);
+    }
+    
+    void append(const uint32_t* itemset, int count) {
+        items.insert(items.end(), itemset, itemset + width);
+        counts.push_back(count);
+    }
+    
+    // Make room for itemset_count itemsets, to be filled with set() from any thread
+    void resize(size_t itemset_count) {
+        items.resize(itemset_count * width);
+        counts.resize(itemset_count);
+    }
+    
+    void set(size_t i, const uint32_t* itemset, int count) {
+        copy(itemset, itemset + width, items.begin() + i * width);
+        counts[i] = count;
+    }
+    
+    // Append the itemsets of another store of the same width
+    void appendAll(const ItemsetStore& other) {
+        items.insert(items.end(), other.items.begin(), other.items.end());
+        counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+    }
+    
+    // Keep the itemsets counted at least min_count times, compacting in place
+    void retainAtLeast(int min_count) {
+        size_t kept = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] < min_count) continue;
+            if (kept != i) {
+                copy(items.begin() + i * width, items.begin() + (i + 1) * width, items.begin() + kept * width);
+                counts[kept] = counts[i];
+            }
+            kept++;
+        }
+        items.resize(kept * width);
+        counts.resize(kept);
+        slots.clear();
+    }
+    
+    // Put the itemsets in lexicographic order
+    void sortItemsets() {
+        vector<uint32_t> order(size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return lexicographical_compare(itemset(a), itemset(a) + width, itemset(b), itemset(b) + width);
+        });
+        
+        ItemsetStore sorted(width);
+        sorted.reserve(size());
+        for (uint32_t i : order) {
+            sorted.append(itemset(i), counts[i]);
+        }
+        swap(sorted);
+    }
+    
+    // Index every itemset in a table of at least twice as many slots, probed linearly
+    void buildIndex() {
+        size_t capacity = 16;
+        while (capacity < 2 * size()) capacity *= 2;
+        slots.assign(capacity, 0);
+        
+        ItemsetHash hasher;
+        for (size_t i = 0; i < size(); i++) {
+            size_t slot = hasher(itemset(i), width) & (capacity - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (capacity - 1);
+            slots[slot] = i + 1;
+        }
+    }
+    
+    // Position of an itemset of this width, or -1; needs buildIndex(). W, when not 0,
+    // must equal the width and lets hashing and comparison unroll.
+    template <size_t W = 0>
+    long long find(const uint32_t* wanted) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = ItemsetHash().hashItems<W>(wanted, width) & mask;
+        while (slots[slot] != 0) {
+            size_t i = slots[slot] - 1;
+            if (sameItems<W>(wanted, itemset(i), width)) return i;
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+    
+    void swap(ItemsetStore& other) {
+        std::swap(width, other.width);
+        items.swap(other.items);
+        counts.swap(other.counts);
+        slots.swap(other.slots);
+    }
+    
+    // Conversions for the stages that still keep itemsets of mixed sizes in a map
+    static ItemsetStore fromMap(const map<vector<uint32_t>, int>& itemsets) {
+        ItemsetStore store(itemsets.empty() ? 0 : itemsets.begin()->first.size());
+        store.reserve(itemsets.size());
+        for (const auto& pair : itemsets) {
+            store.append(pair.first.data(), pair.second);
+        }
+        return store;
+    }
+    
+    void addTo(map<vector<uint32_t>, int>& itemsets) const {
+        for (size_t i = 0; i < size(); i++) {
+            itemsets.emplace_hint(itemsets.end(), vector<uint32_t>(itemset(i), itemset(i) + width), counts[i]);
+        }
+    }
+};
+
+// Item text pointing into the memory-mapped input file
+struct Token {
+    const char* data;
+    size_t length;
+    
+    bool operator==(const Token& other) const {
+        return length == other.length && memcmp(data, other.data, length) == 0;
+    }
+};
+
+// FNV-1a hash over the bytes of a token
+struct TokenHash {
+    size_t operator()(const Token& token) const {
+        size_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < token.length; i++) {
+            hash ^= (unsigned char)token.data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// Header of the binary transaction database written by convert. The header is
+// followed by the item dictionary and the distinct transactions in CSR form,
+// with every section starting on an 8-byte boundary.
+struct BinaryDatabaseHeader {
+    char magic[8];                // "APRIODB1"
+    uint64_t item_count;
+    uint64_t transaction_count;   // Distinct transactions
+    uint64_t total_transactions;  // Transactions in the source file, duplicates included
+    uint64_t item_entries;        // Length of the items section
+    uint64_t names_bytes;
+};
+
+// Byte offsets of the sections that follow the header
+struct BinaryDatabaseLayout {
+    uint64_t name_offsets;  // uint64_t[item_count + 1] into names
+    uint64_t names;         // char[names_bytes], item names in ID order
+    uint64_t offsets;       // uint64_t[transaction_count + 1] into items
+    uint64_t weights;       // uint32_t[transaction_count]
+    uint64_t items;         // uint32_t[item_entries], sorted item IDs per transaction
+    uint64_t file_size;
+    
+    BinaryDatabaseLayout(const BinaryDatabaseHeader& header) {
+        name_offsets = align(sizeof(BinaryDatabaseHeader));
+        names = align(name_offsets + (header.item_count + 1) * sizeof(uint64_t));
+        offsets = align(names + header.names_bytes);
+        weights = align(offsets + (header.transaction_count + 1) * sizeof(uint64_t));
+        items = align(weights + header.transaction_count * sizeof(uint32_t));
+        file_size = items + header.item_entries * sizeof(uint32_t);
+    }
+    
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+};
+
+// Level-2 pairs are counted in triangular matrices, one per thread plus the reduced
+// one, while they have at most this many entries together
+const size_t MAX_PAIR_MATRIX_ENTRIES = size_t(1) << 24;
+
+// Subset kernels over item bitmaps: add the weight to counts[c] for every candidate
+// bitmap contained in the transaction bitmap. Candidates are stored back to back,
+// `words` 64-bit words each.
+typedef void (*BitmapKernel)(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts);
+
+static void countBitmapsScalar(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * words;
+        uint64_t missing = 0;
+        for (size_t w = 0; w < words; w++) {
+            missing |= candidate[w] & ~transaction[w];
+        }
+        if (missing == 0) counts[c] += weight;
+    }
+}
+
+#ifdef HAVE_X86_BITMAP_KERNELS
+// testc is set when no candidate bit is missing from the transaction
+__attribute__((target("avx2")))
+static void countBitmapsAVX2(const uint64_t* candidates, size_t candidate_count, size_t words,
+                             const uint64_t* transaction, int weight, int* counts) {
+    __m256i low = _mm256_loadu_si256((const __m256i*)transaction);
+    if (words == 4) {
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m256i candidate = _mm256_loadu_si256((const __m256i*)(candidates + c * 4));
+            if (_mm256_testc_si256(low, candidate)) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m256i high = _mm256_loadu_si256((const __m256i*)(transaction + 4));
+    for (size_t c = 0; c < candidate_count; c++) {
+        const uint64_t* candidate = candidates + c * 8;
+        if (_mm256_testc_si256(low, _mm256_loadu_si256((const __m256i*)candidate)) &
+            _mm256_testc_si256(high, _mm256_loadu_si256((const __m256i*)(candidate + 4)))) {
+            counts[c] += weight;
+        }
+    }
+}
+
+// 512-bit universes test one candidate per instruction, 256-bit universes two
+__attribute__((target("avx512f")))
+static void countBitmapsAVX512(const uint64_t* candidates, size_t candidate_count, size_t words,
+                               const uint64_t* transaction, int weight, int* counts) {
+    if (words == 8) {
+        __m512i bits = _mm512_loadu_si512(transaction);
+        for (size_t c = 0; c < candidate_count; c++) {
+            __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 8));
+            if (_mm512_test_epi64_mask(missing, missing) == 0) counts[c] += weight;
+        }
+        return;
+    }
+    
+    __m512i bits = _mm512_broadcast_i64x4(_mm256_loadu_si256((const __m256i*)transaction));
+    size_t c = 0;
+    for (; c + 2 <= candidate_count; c += 2) {
+        __m512i missing = _mm512_andnot_si512(bits, _mm512_loadu_si512(candidates + c * 4));
+        __mmask8 mask = _mm512_test_epi64_mask(missing, missing);
+        if ((mask & 0x0F) == 0) counts[c] += weight;
+        if ((mask & 0xF0) == 0) counts[c + 1] += weight;
+    }
+    countBitmapsScalar(candidates + c * 4, candidate_count - c, 4, transaction, weight, counts + c);
+}
+#endif
+
+// Pick the widest kernel the running CPU supports
+static BitmapKernel selectBitmapKernel() {
+#ifdef HAVE_X86_BITMAP_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return countBitmapsAVX512;
+    if (__builtin_cpu_supports("avx2")) return countBitmapsAVX2;
+#endif
+    return countBitmapsScalar;
+}
+
+// Candidates of one level as fixed-width item bitmaps, usable when there are at most
+// 1024 candidates spanning at most 512 distinct items. Each transaction is turned into
+// a bitmap once and tested against every candidate with a few vector instructions.
+class BitmapCounter {
+private:
+    vector<int> item_bit;             // Bit of each item, -1 if no candidate uses it
+    vector<uint64_t> candidate_bits;  // `words` words per candidate, back to back
+    size_t candidate_count;
+    size_t words;                     // 4 (256 bits) or 8 (512 bits); 0 if the bitmaps are not used
+    size_t depth;
+    BitmapKernel kernel;
+    
+public:
+    BitmapCounter(const ItemsetStore& candidates, size_t item_count)
+        : item_bit(item_count, -1), candidate_count(candidates.size()), words(0),
+          depth(candidates.itemsetWidth()), kernel(selectBitmapKernel()) {
+        int universe = 0;
+        for (size_t c = 0; c < candidate_count; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                uint32_t item = candidates.itemset(c)[i];
+                if (item_bit[item] < 0) item_bit[item] = universe++;
+            }
+        }
+        // Every transaction is tested against every candidate, so beyond about a thousand
+        // candidates the trie, which only visits candidates sharing a prefix, is faster
+        if (universe > 512 || candidate_count > 1024) return;
+        
+        words = universe <= 256 ? 4 : 8;
+        candidate_bits.assign(candidate_count * words, 0);
+        for (size_t c = 0; c < candidate_count; c++) {
+            for (size_t i = 0; i < depth; i++) {
+                int bit = item_bit[candidates.itemset(c)[i]];
+                candidate_bits[c * words + bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+        }
+    }
+    
+    bool usable() const {
+        return words != 0;
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (candidate_count == 0 || transaction.size() < depth) return;
+        
+        uint64_t bits[8] = {0};
+        size_t present = 0;
+        for (uint32_t item : transaction) {
+            int bit = item_bit[item];
+            if (bit < 0) continue;
+            bits[bit / 64] |= uint64_t(1) << (bit % 64);
+            present++;
+        }
+        
+        if (present >= depth) {
+            kernel(candidate_bits.data(), candidate_count, words, bits, weight, counts.data());
+        }
+    }
+};
+
+// Prefix trie over the candidates of one level. Each transaction walks the
+// trie once and increments only the candidates it contains.
+class CandidateTrie {
+private:
+    struct Node {
+        vector<uint32_t> items;  // Sorted child items
+        vector<int> children;    // Child node index, or candidate index at the last level
+    };
+    
+    vector<Node> nodes;
+    size_t depth;
+    
+    void countNode(int node, const vector<uint32_t>& transaction, size_t start,
+                   size_t level, int weight, vector<int>& counts) const {
+        const Node& current = nodes[node];
+        size_t remaining = depth - level - 1;
+        size_t last = transaction.size() - remaining;
+        size_t child = 0;
+        
+        for (size_t t = start; t < last; t++) {
+            auto it = lower_bound(current.items.begin() + child, current.items.end(), transaction[t]);
+            if (it == current.items.end()) break;
+            
+            child = it - current.items.begin();
+            if (*it == transaction[t]) {
+                if (remaining == 0) {
+                    counts[current.children[child]] += weight;
+                } else {
+                    countNode(current.children[child], transaction, t + 1, level + 1, weight, counts);
+                }
+                child++;
+            }
+        }
+    }
+    
+public:
+    // Candidates must be in sorted order
+    CandidateTrie(const ItemsetStore& candidates)
+        : nodes(1), depth(candidates.empty() ? 0 : candidates.itemsetWidth()) {
+        for (size_t c = 0; c < candidates.size(); c++) {
+            int node = 0;
+            for (size_t level = 0; level < depth; level++) {
+                uint32_t item = candidates.itemset(c)[level];
+                bool leaf = (level + 1 == depth);
+                
+                // Sorted insertion means a shared prefix is always the last child
+                if (nodes[node].items.empty() || nodes[node].items.back() != item) {
+                    int target = leaf ? (int)c : (int)nodes.size();
+                    nodes[node].items.push_back(item);
+                    nodes[node].children.push_back(target);
+                    if (!leaf) nodes.push_back(Node());
+                }
+                node = nodes[node].children.back();
+            }
+        }
+    }
+    
+    // Add the transaction weight to every candidate contained in the transaction
+    void count(const vector<uint32_t>& transaction, int weight, vector<int>& counts) const {
+        if (depth == 0 || transaction.size() < depth) return;
+        countNode(0, transaction, 0, 0, weight, counts);
+    }
+};
+
+// FP-tree: transactions are inserted with their items in a fixed header order,
+// so transactions sharing a prefix share a path of counted nodes
+class FPTree {
+private:
+    struct Node {
+        uint32_t item;
+        int count;
+        int parent;
+        int first_child;
+        int next_sibling;
+        int next_same_item;  // Next node in the header chain of this item
+    };
+    
+    struct HeaderEntry {
+        uint32_t item;
+        int support;
+        int first_node;
+    };
+    
+    vector<Node> nodes;                   // Node 0 is the root
+    vector<HeaderEntry> header;           // Frequent items in tree order
+    unordered_map<uint32_t, int> header_index;
+    int min_support;
+    
+public:
+    FPTree(int min_sup) : min_support(min_sup) {
+        Node root = {0, 0, -1, -1, -1, -1};
+        nodes.push_back(root);
+    }
+    
+    // Fix the tree order; items missing from ordered_items are dropped on insert
+    void setHeader(const vector<pair<uint32_t, int>>& ordered_items) {
+        header.clear();
+        header_index.clear();
+        for (const auto& pair : ordered_items) {
+            header_index[pair.first] = header.size();
+            HeaderEntry entry = {pair.first, pair.second, -1};
+            header.push_back(entry);
+        }
+    }
+    
+    // Order (item, support) pairs by descending support, breaking ties by item ID
+    static void sortBySupport(vector<pair<uint32_t, int>>& items) {
+        sort(items.begin(), items.end(), [](const pair<uint32_t, int>& a, const pair<uint32_t, int>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+    
+    // Insert a transaction with the given multiplicity
+    void insert(const vector<uint32_t>& transaction, int count) {
+        vector<int> path;
+        for (uint32_t item : transaction) {
+            auto it = header_index.find(item);
+            if (it != header_index.end()) {
+                path.push_back(it->second);
+            }
+        }
+        sort(path.begin(), path.end());
+        
+        int node = 0;
+        for (int h : path) {
+            int child = nodes[node].first_child;
+            while (child != -1 && nodes[child].item != header[h].item) {
+                child = nodes[child].next_sibling;
+            }
+            
+            if (child == -1) {
+                child = nodes.size();
+                Node created = {header[h].item, 0, node, -1, nodes[node].first_child, header[h].first_node};
+                nodes.push_back(created);
+                nodes[node].first_child = child;
+                header[h].first_node = child;
+            }
+            
+            nodes[child].count += count;
+            node = child;
+        }
+    }
+    
+    size_t headerSize() const {
+        return header.size();
+    }
+    
+    uint32_t headerItem(size_t h) const {
+        return header[h].item;
+    }
+    
+    // Mine every frequent itemset that ends with header item h, extended by suffix
+    void mineItem(size_t h, vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        suffix.push_back(header[h].item);
+        vector<uint32_t> itemset = suffix;
+        sort(itemset.begin(), itemset.end());
+        results[itemset] = header[h].support;
+        
+        // Conditional pattern base: the path above every node of this item
+        vector<pair<vector<uint32_t>, int>> pattern_base;
+        unordered_map<uint32_t, int> conditional_counts;
+        for (int n = header[h].first_node; n != -1; n = nodes[n].next_same_item) {
+            vector<uint32_t> path;
+            for (int p = nodes[n].parent; p != 0; p = nodes[p].parent) {
+                path.push_back(nodes[p].item);
+                conditional_counts[nodes[p].item] += nodes[n].count;
+            }
+            if (!path.empty()) {
+                pattern_base.push_back(make_pair(path, nodes[n].count));
+            }
+        }
+        
+        vector<pair<uint32_t, int>> conditional_items;
+        for (const auto& pair : conditional_counts) {
+            if (pair.second >= min_support) {
+                conditional_items.push_back(pair);
+            }
+        }
+        
+        if (!conditional_items.empty()) {
+            sortBySupport(conditional_items);
+            FPTree conditional(min_support);
+            conditional.setHeader(conditional_items);
+            for (const auto& pattern : pattern_base) {
+                conditional.insert(pattern.first, pattern.second);
+            }
+            conditional.mine(suffix, results);
+        }
+        
+        suffix.pop_back();
+    }
+    
+    // Mine the whole tree, least frequent header items first
+    void mine(vector<uint32_t>& suffix, map<vector<uint32_t>, int>& results) const {
+        for (size_t h = header.size(); h-- > 0;) {
+            mineItem(h, suffix, results);
+        }
+    }
+};
+
+// Member of an Eclat prefix class: the extending item and the bitset of
+// transactions containing prefix + item
+struct EclatMember {
+    uint32_t item;
+    int support;
+    vector<uint64_t> tids;
+};
+
+// Association rule antecedent -> consequent, both sorted item IDs
+struct AssociationRule {
+    vector<uint32_t> antecedent;
+    vector<uint32_t> consequent;
+    int support;        // Support of antecedent and consequent together
+    double confidence;  // support / support(antecedent)
+    double lift;        // confidence / (support(consequent) / transactions)
+};
+
 class ParallelApriori {
 private:
     int min_support;
-    vector<vector<string>> transactions;
+    vector<vector<uint32_t>> transactions;  // Distinct transactions
+    vector<int> transaction_weights;        // Multiplicity of each distinct transaction
+    int total_transactions;                 // Transactions in the file, duplicates included
+    bool unit_weights;                      // True when no transaction was collapsed
+    vector<string> item_names;              // Item dictionary: item ID -> item name
     int num_threads;
     
 public:
-    ParallelApriori(int min_sup, int threads = 0) : min_support(min_sup) {
+    ParallelApriori(int min_sup, int threads = 0)
+        : min_support(min_sup), total_transactions(0), unit_weights(true) {
         if (threads > 0) {
             num_threads = threads;
             omp_set_num_threads(threads);
@@ -28,260 +634,1068 @@ public:
         }
     }
     
-    // Read transactions from file
-    bool loadTransactions(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cerr << "Error: Cannot open file " << filename << endl;
-            return false;
+    // Read transactions from a memory-mapped file, parsing newline-aligned chunks
+    // on all threads and encoding every item as an integer ID
+    bool loadTransactions(const string& filename) {
+        if (isBinaryDatabase(filename)) {
+            return loadBinaryDatabase(filename);
+        }
+        
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            return false;
+        }
+        
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0) {
+            cerr << "Error: Cannot stat file " << filename << endl;
+            close(fd);
+            return false;
+        }
+        
+        size_t file_size = file_stat.st_size;
+        const char* data = nullptr;
+        if (file_size > 0) {
+            void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                cerr << "Error: Cannot map file " << filename << endl;
+                close(fd);
+                return false;
+            }
+            madvise(mapped, file_size, MADV_SEQUENTIAL);
+            data = (const char*)mapped;
+        }
+        
+        unordered_map<string, uint32_t> item_ids;
+        transactions.clear();
+        parseText(data, file_size, item_ids, transactions);
+        
+        if (data != nullptr) {
+            munmap((void*)data, file_size);
+        }
+        close(fd);
+        
+        total_transactions = transactions.size();
+        buildItemDictionary(item_ids);
+        collapseDuplicateTransactions();
+        cout << "Loaded " << total_transactions << " transactions ("
+             << transactions.size() << " distinct)" << endl;
+        return true;
+    }
+    
+    // Parse the text in [data, data + size) on all threads, splitting it into
+    // newline-aligned chunks, and append its transactions to parsed. Items are
+    // encoded through item_ids, which keeps the IDs of items seen before.
+    void parseText(const char* data, size_t size, unordered_map<string, uint32_t>& item_ids,
+                   vector<vector<uint32_t>>& parsed) {
+        // Split the text into chunks that each start right after a newline
+        int num_chunks = num_threads * 4;
+        vector<size_t> bounds(num_chunks + 1, size);
+        bounds[0] = 0;
+        for (int c = 1; c < num_chunks; c++) {
+            size_t pos = max(bounds[c - 1], size / num_chunks * c);
+            while (pos > 0 && pos < size && data[pos - 1] != '\n') pos++;
+            bounds[c] = pos;
+        }
+        
+        // Parse every chunk with its own token dictionary
+        vector<unordered_map<Token, uint32_t, TokenHash>> chunk_ids(num_chunks);
+        vector<vector<Token>> chunk_tokens(num_chunks);
+        vector<vector<vector<uint32_t>>> chunk_transactions(num_chunks);
+        
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < num_chunks; c++) {
+            parseChunk(data + bounds[c], data + bounds[c + 1],
+                       chunk_ids[c], chunk_tokens[c], chunk_transactions[c]);
+        }
+        
+        // Merge chunk dictionaries; item strings are only created once per chunk-distinct item
+        vector<vector<uint32_t>> chunk_remap(num_chunks);
+        for (int c = 0; c < num_chunks; c++) {
+            for (const Token& token : chunk_tokens[c]) {
+                auto inserted = item_ids.insert(make_pair(string(token.data, token.length),
+                                                          (uint32_t)item_ids.size()));
+                chunk_remap[c].push_back(inserted.first->second);
+            }
+        }
+        
+        vector<size_t> chunk_offsets(num_chunks + 1, parsed.size());
+        for (int c = 0; c < num_chunks; c++) {
+            chunk_offsets[c + 1] = chunk_offsets[c] + chunk_transactions[c].size();
+        }
+        parsed.resize(chunk_offsets[num_chunks]);
+        
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < num_chunks; c++) {
+            for (size_t t = 0; t < chunk_transactions[c].size(); t++) {
+                vector<uint32_t>& transaction = chunk_transactions[c][t];
+                for (uint32_t& item : transaction) {
+                    item = chunk_remap[c][item];
+                }
+                parsed[chunk_offsets[c] + t].swap(transaction);
+            }
+        }
+    }
+    
+    // Read the next chunk of about chunk_bytes from file, extended to the end of
+    // the line it stops in; returns false at the end of the file
+    bool readTextChunk(ifstream& file, size_t chunk_bytes, string& text) {
+        text.resize(chunk_bytes);
+        file.read(&text[0], chunk_bytes);
+        text.resize(file.gcount());
+        if (text.empty()) return false;
+        
+        string rest;
+        if (text.back() != '\n' && getline(file, rest)) {
+            text += rest;
+            text += '\n';
+        }
+        return true;
+    }
+    
+    // Check whether the file starts with the binary database magic
+    bool isBinaryDatabase(const string& filename) {
+        ifstream file(filename, ios::binary);
+        char magic[8] = {0};
+        file.read(magic, sizeof(magic));
+        return file.gcount() == sizeof(magic) && memcmp(magic, "APRIODB1", sizeof(magic)) == 0;
+    }
+    
+    // Load a binary database written by convert; the file is mapped and the
+    // already encoded, deduplicated transactions are copied out without parsing
+    bool loadBinaryDatabase(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd < 0 || fstat(fd, &file_stat) != 0) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        
+        size_t file_size = file_stat.st_size;
+        void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            cerr << "Error: Cannot map file " << filename << endl;
+            return false;
+        }
+        
+        const char* data = (const char*)mapped;
+        const BinaryDatabaseHeader* header = (const BinaryDatabaseHeader*)data;
+        BinaryDatabaseLayout layout(*header);
+        if (file_size < layout.file_size) {
+            cerr << "Error: Binary database " << filename << " is truncated" << endl;
+            munmap(mapped, file_size);
+            return false;
+        }
+        
+        const uint64_t* name_offsets = (const uint64_t*)(data + layout.name_offsets);
+        const char* names = data + layout.names;
+        item_names.resize(header->item_count);
+        for (size_t i = 0; i < item_names.size(); i++) {
+            item_names[i].assign(names + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+        }
+        
+        const uint64_t* offsets = (const uint64_t*)(data + layout.offsets);
+        const uint32_t* weights = (const uint32_t*)(data + layout.weights);
+        const uint32_t* items = (const uint32_t*)(data + layout.items);
+        transactions.resize(header->transaction_count);
+        transaction_weights.assign(weights, weights + header->transaction_count);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int t = 0; t < (int)transactions.size(); t++) {
+            transactions[t].assign(items + offsets[t], items + offsets[t + 1]);
+        }
+        
+        total_transactions = header->total_transactions;
+        unit_weights = (transactions.size() == (size_t)total_transactions);
+        munmap(mapped, file_size);
+        
+        cout << "Loaded " << total_transactions << " transactions ("
+             << transactions.size() << " distinct) from binary database" << endl;
+        return true;
+    }
+    
+    // Tokenize the lines in [begin, end) in place: items are comma separated,
+    // trimmed of spaces and tabs, and empty items and the -1 sentinel are skipped
+    void parseChunk(const char* begin, const char* end,
+                    unordered_map<Token, uint32_t, TokenHash>& token_ids,
+                    vector<Token>& tokens, vector<vector<uint32_t>>& chunk) {
+        vector<uint32_t> transaction;
+        const char* line = begin;
+        
+        while (line < end) {
+            const char* line_end = (const char*)memchr(line, '\n', end - line);
+            if (line_end == nullptr) line_end = end;
+            
+            transaction.clear();
+            const char* field = line;
+            while (field < line_end) {
+                const char* field_end = (const char*)memchr(field, ',', line_end - field);
+                if (field_end == nullptr) field_end = line_end;
+                
+                // Trim whitespace
+                const char* first = field;
+                const char* last = field_end;
+                while (first < last && (*first == ' ' || *first == '\t')) first++;
+                while (last > first && (last[-1] == ' ' || last[-1] == '\t')) last--;
+                
+                size_t length = last - first;
+                if (length > 0 && !(length == 2 && first[0] == '-' && first[1] == '1')) {
+                    Token token = {first, length};
+                    auto inserted = token_ids.insert(make_pair(token, (uint32_t)tokens.size()));
+                    if (inserted.second) tokens.push_back(token);
+                    transaction.push_back(inserted.first->second);
+                }
+                
+                field = field_end + 1;
+            }
+            
+            if (!transaction.empty()) {
+                chunk.push_back(transaction);
+            }
+            line = line_end + 1;
+        }
+    }
+    
+    // Renumber item IDs in name order so integer itemsets sort like string itemsets
+    void buildItemDictionary(const unordered_map<string, uint32_t>& item_ids) {
+        vector<string> names(item_ids.size());
+        for (const auto& pair : item_ids) {
+            names[pair.second] = pair.first;
+        }
+        
+        vector<uint32_t> order(names.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return names[a] < names[b];
+        });
+        
+        vector<uint32_t> new_ids(names.size());
+        item_names.resize(names.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            new_ids[order[i]] = i;
+            item_names[i] = names[order[i]];
+        }
+        
+        // Rewrite transactions as sorted sets of the final IDs
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int t = 0; t < (int)transactions.size(); t++) {
+            vector<uint32_t>& transaction = transactions[t];
+            for (uint32_t& item : transaction) {
+                item = new_ids[item];
+            }
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        }
+    }
+    
+    // Collapse identical sorted transactions into one transaction with a multiplicity
+    void collapseDuplicateTransactions() {
+        sort(transactions.begin(), transactions.end());
+        transaction_weights.clear();
+        
+        size_t distinct = 0;
+        for (size_t i = 0; i < transactions.size(); i++) {
+            if (distinct > 0 && transactions[i] == transactions[distinct - 1]) {
+                transaction_weights.back()++;
+                continue;
+            }
+            if (i != distinct) {
+                transactions[distinct].swap(transactions[i]);
+            }
+            transaction_weights.push_back(1);
+            distinct++;
+        }
+        transactions.resize(distinct);
+        
+        unit_weights = (distinct == (size_t)total_transactions);
+    }
+    
+    // Parallel generation of frequent 1-itemsets
+    ItemsetStore generateFrequent1Itemsets() {
+        size_t item_count = item_names.size();
+        vector<vector<int>> thread_counts(num_threads, vector<int>(item_count, 0));
+        vector<int> item_counts(item_count, 0);
+        
+        #pragma omp parallel
+        {
+            vector<int>& local_counts = thread_counts[omp_get_thread_num()];
+            
+            // Count into a dense per-thread array indexed by item ID
+            #pragma omp for schedule(dynamic, 1024)
+            for (int i = 0; i < (int)transactions.size(); i++) {
+                for (uint32_t item : transactions[i]) {
+                    local_counts[item] += transaction_weights[i];
+                }
+            }
+            
+            // Reduce the per-thread arrays, each thread summing a range of items
+            #pragma omp for
+            for (int item = 0; item < (int)item_count; item++) {
+                int total_count = 0;
+                for (int t = 0; t < num_threads; t++) {
+                    total_count += thread_counts[t][item];
+                }
+                item_counts[item] = total_count;
+            }
+        }
+        
+        // Filter by minimum support; item IDs come out in sorted order
+        ItemsetStore frequent_1_itemsets(1);
+        for (uint32_t item = 0; item < item_count; item++) {
+            if (item_counts[item] >= min_support) {
+                frequent_1_itemsets.append(&item, item_counts[item]);
+            }
+        }
+        
+        return frequent_1_itemsets;
+    }
+    
+    // Generate candidate itemsets from frequent k-itemsets (Apriori-gen), with the
+    // candidate width fixed at compile time for the common small levels
+    ItemsetStore generateCandidates(ItemsetStore& frequent_k) {
+        static_assert(MAX_FIXED_WIDTH == 8, "the cases below must cover widths 2 to MAX_FIXED_WIDTH");
+        frequent_k.buildIndex();
+        
+        switch (frequent_k.itemsetWidth() + 1) {
+            case 2: return joinLevel<2>(frequent_k);
+            case 3: return joinLevel<3>(frequent_k);
+            case 4: return joinLevel<4>(frequent_k);
+            case 5: return joinLevel<5>(frequent_k);
+            case 6: return joinLevel<6>(frequent_k);
+            case 7: return joinLevel<7>(frequent_k);
+            case 8: return joinLevel<8>(frequent_k);
+            default: return joinLevel<0>(frequent_k);
+        }
+    }
+    
+    // Join the indexed frequent itemsets into candidates of K items, or of any width
+    // when K is 0. The frequent itemsets are sorted, so itemsets sharing their first
+    // k-1 items form contiguous prefix classes, and only pairs within a class are joined.
+    template <size_t K>
+    ItemsetStore joinLevel(const ItemsetStore& frequent_k) {
+        size_t k = K ? K - 1 : frequent_k.itemsetWidth();
+        int itemset_count = frequent_k.size();
+        
+        // Record where the prefix class of each itemset ends
+        vector<size_t> class_end(itemset_count);
+        size_t class_start = 0;
+        while (class_start < frequent_k.size()) {
+            size_t end = prefixClassEnd<K>(frequent_k, class_start);
+            fill(class_end.begin() + class_start, class_end.begin() + end, end);
+            class_start = end;
+        }
+        
+        // Parallel candidate generation. Each thread appends to its own store and
+        // notes where the candidates joined from every itemset start there.
+        vector<ItemsetStore> thread_candidates(num_threads, ItemsetStore(k + 1));
+        vector<int> owner(itemset_count);
+        vector<size_t> first(itemset_count);
+        vector<size_t> offset(itemset_count + 1, 0);
+        
+        #pragma omp parallel
+        {
+            int thread_id = omp_get_thread_num();
+            ItemsetStore& local_candidates = thread_candidates[thread_id];
+            
+            array<uint32_t, MAX_FIXED_WIDTH> fixed_candidate;
+            array<uint32_t, MAX_FIXED_WIDTH> fixed_subset;
+            vector<uint32_t> wide_candidate(K ? 0 : k + 1);
+            vector<uint32_t> wide_subset(K ? 0 : k);
+            uint32_t* candidate = K ? fixed_candidate.data() : wide_candidate.data();
+            uint32_t* subset = K ? fixed_subset.data() : wide_subset.data();
+            
+            #pragma omp for schedule(dynamic)
+            for (int i = 0; i < itemset_count; i++) {
+                owner[i] = thread_id;
+                first[i] = local_candidates.size();
+                copy(frequent_k.itemset(i), frequent_k.itemset(i) + (K ? K - 1 : k), candidate);
+                
+                for (size_t j = i + 1; j < class_end[i]; j++) {
+                    candidate[k] = frequent_k.itemset(j)[k - 1];
+                    if (hasFrequentSubsets<K>(candidate, k + 1, frequent_k, subset)) {
+                        local_candidates.append(candidate, 0);
+                    }
+                }
+                offset[i + 1] = local_candidates.size() - first[i];
+            }
+        }
+        
+        // Gather in itemset order, which is sorted order
+        partial_sum(offset.begin(), offset.end(), offset.begin());
+        ItemsetStore candidates(k + 1);
+        candidates.resize(offset[itemset_count]);
+        
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int i = 0; i < itemset_count; i++) {
+            const ItemsetStore& source = thread_candidates[owner[i]];
+            for (size_t c = 0; c < offset[i + 1] - offset[i]; c++) {
+                candidates.set(offset[i] + c, source.itemset(first[i] + c), 0);
+            }
+        }
+        
+        return candidates;
+    }
+    
+    // Find the end of the prefix class that starts at itemset `start`, for joins
+    // into candidates of K items (any width when K is 0)
+    template <size_t K>
+    size_t prefixClassEnd(const ItemsetStore& itemsets, size_t start) {
+        size_t prefix = itemsets.itemsetWidth() - 1;
+        size_t end = start + 1;
+        while (end < itemsets.size() &&
+               sameItems<K ? K - 2 : 0>(itemsets.itemset(start), itemsets.itemset(end), prefix)) {
+            end++;
+        }
+        return end;
+    }
+    
+    // Check that every k-subset of a (k+1)-candidate of `width` items is frequent
+    // (downward closure), using `subset` as scratch space for k items. The subsets
+    // dropping either of the last two items are the joined itemsets themselves.
+    template <size_t K>
+    bool hasFrequentSubsets(const uint32_t* candidate, size_t width, const ItemsetStore& frequent_k,
+                            uint32_t* subset) {
+        size_t n = K ? K : width;
+        if (n <= 2) return true;
+        
+        for (size_t i = 1; i < n; i++) {
+            subset[i - 1] = candidate[i];
+        }
+        for (size_t skip = 0; skip + 2 < n; skip++) {
+            if (skip > 0) subset[skip - 1] = candidate[skip - 1];
+            if (frequent_k.find<K ? K - 1 : 0>(subset) < 0) {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    // Parallel support counting in place, using a prefix trie built once for this level
+    void countSupport(ItemsetStore& candidates, const vector<vector<uint32_t>>& database,
+                      const vector<int>& weights) {
+        // Candidates over a small item universe are tested as bitmaps, others walk the trie
+        BitmapCounter bitmap(candidates, item_names.size());
+        CandidateTrie trie(bitmap.usable() ? ItemsetStore() : candidates);
+        
+        // Each thread tests its transactions against the shared bitmaps or trie
+        vector<vector<int>> thread_counts(num_threads, vector<int>(candidates.size(), 0));
+        int* counts = candidates.countData();
+        
+        #pragma omp parallel
+        {
+            int thread_id = omp_get_thread_num();
+            
+            #pragma omp for schedule(dynamic, 256)
+            for (int i = 0; i < (int)database.size(); i++) {
+                if (bitmap.usable()) {
+                    bitmap.count(database[i], weights[i], thread_counts[thread_id]);
+                } else {
+                    trie.count(database[i], weights[i], thread_counts[thread_id]);
+                }
+            }
+            
+            // Aggregate results, each thread summing a range of candidates
+            #pragma omp for
+            for (int c = 0; c < (int)candidates.size(); c++) {
+                int total_count = 0;
+                for (int t = 0; t < num_threads; t++) {
+                    total_count += thread_counts[t][c];
+                }
+                counts[c] = total_count;
+            }
+        }
+    }
+    
+    // Count every pair of frequent items in one pass, into flat upper-triangular
+    // per-thread matrices indexed by item rank, and return the frequent 2-itemsets
+    ItemsetStore countFrequentPairs(const ItemsetStore& frequent_1, const vector<vector<uint32_t>>& database,
+                                    const vector<int>& weights) {
+        vector<uint32_t> items;
+        vector<int> item_rank(item_names.size(), -1);
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            item_rank[frequent_1.itemset(i)[0]] = items.size();
+            items.push_back(frequent_1.itemset(i)[0]);
+        }
+        size_t n = items.size();
+        
+        size_t entries = n * (n - 1) / 2;
+        vector<vector<uint32_t>> thread_matrices(num_threads, vector<uint32_t>(entries, 0));
+        vector<uint32_t> matrix(entries, 0);
+        
+        #pragma omp parallel
+        {
+            vector<uint32_t>& local_matrix = thread_matrices[omp_get_thread_num()];
+            vector<uint32_t> ranks;
+            
+            #pragma omp for schedule(dynamic, 256)
+            for (int t = 0; t < (int)database.size(); t++) {
+                ranks.clear();
+                for (uint32_t item : database[t]) {
+                    if (item_rank[item] >= 0) ranks.push_back(item_rank[item]);
+                }
+                for (size_t a = 0; a < ranks.size(); a++) {
+                    size_t r = ranks[a];
+                    size_t row = pairRowStart(r, n);
+                    for (size_t b = a + 1; b < ranks.size(); b++) {
+                        local_matrix[row + (ranks[b] - r - 1)] += weights[t];
+                    }
+                }
+            }
+            
+            // Reduce the per-thread matrices, each thread summing a range of entries
+            #pragma omp for
+            for (long long i = 0; i < (long long)entries; i++) {
+                uint32_t total_count = 0;
+                for (int th = 0; th < num_threads; th++) {
+                    total_count += thread_matrices[th][i];
+                }
+                matrix[i] = total_count;
+            }
+        }
+        
+        return readFrequentPairs(items, matrix);
+    }
+    
+    // Level 2 uses the pair matrix when there are pairs to count and the per-thread
+    // matrices together with their reduction are small enough
+    bool pairMatrixFits(size_t frequent_items) {
+        if (frequent_items < 2) return false;
+        size_t entries = frequent_items * (frequent_items - 1) / 2;
+        return entries * (num_threads + 1) <= MAX_PAIR_MATRIX_ENTRIES;
+    }
+    
+    // Offset of row r in the flat upper-triangular matrix over n items; pair (r, c)
+    // with r < c lives at pairRowStart(r, n) + (c - r - 1)
+    size_t pairRowStart(size_t r, size_t n) {
+        return r * (2 * n - r - 1) / 2;
+    }
+    
+    // Read the frequent 2-itemsets out of the pair matrix, in itemset order
+    ItemsetStore readFrequentPairs(const vector<uint32_t>& items, const vector<uint32_t>& matrix) {
+        ItemsetStore frequent_pairs(2);
+        size_t index = 0;
+        for (size_t r = 0; r < items.size(); r++) {
+            for (size_t c = r + 1; c < items.size(); c++, index++) {
+                if ((int)matrix[index] >= min_support) {
+                    uint32_t pair[2] = {items[r], items[c]};
+                    frequent_pairs.append(pair, matrix[index]);
+                }
+            }
+        }
+        
+        return frequent_pairs;
+    }
+    
+    // Shrink the working set before counting the next level: drop items that occur
+    // in no candidate, then drop transactions too short to contain a candidate
+    void trimWorkingSet(const ItemsetStore& candidates, size_t min_length,
+                        vector<vector<uint32_t>>& working, vector<int>& working_weights) {
+        vector<char> live_items(item_names.size(), 0);
+        for (size_t c = 0; c < candidates.size(); c++) {
+            for (size_t i = 0; i < candidates.itemsetWidth(); i++) {
+                live_items[candidates.itemset(c)[i]] = 1;
+            }
         }
         
-        string line;
-        transactions.clear();
+        // Filter items of every transaction in parallel
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int t = 0; t < (int)working.size(); t++) {
+            vector<uint32_t>& transaction = working[t];
+            transaction.erase(remove_if(transaction.begin(), transaction.end(),
+                                        [&](uint32_t item) { return !live_items[item]; }),
+                              transaction.end());
+        }
         
-        while (getline(file, line)) {
-            if (line.empty()) continue;
-            
-            vector<string> transaction;
-            stringstream ss(line);
-            string item;
-            
-            while (getline(ss, item, ',')) {
-                // Trim whitespace
-                item.erase(0, item.find_first_not_of(" \t"));
-                item.erase(item.find_last_not_of(" \t") + 1);
+        // Compact surviving transactions towards the front
+        size_t kept = 0;
+        for (size_t t = 0; t < working.size(); t++) {
+            if (working[t].size() < min_length) continue;
+            if (kept != t) {
+                working[kept].swap(working[t]);
+                working_weights[kept] = working_weights[t];
+            }
+            kept++;
+        }
+        
+        working.resize(kept);
+        working_weights.resize(kept);
+    }
+    
+    // Filter candidates by minimum support; the level is moved in and out, not copied
+    ItemsetStore filterBySupport(ItemsetStore candidates) {
+        candidates.retainAtLeast(min_support);
+        return candidates;
+    }
+    
+    // Main parallel Apriori algorithm
+    map<vector<uint32_t>, int> runApriori() {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Parallel Apriori Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl;
+        cout << "Number of threads: " << num_threads << endl << endl;
+        
+        auto all_frequent_itemsets = mineApriori(true);
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nParallel Apriori completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("parallel_results.txt", ios::app);
+        result << "Parallel_" << num_threads << "_threads" << endl << duration.count() << endl;
+        result.close();
+        
+        return all_frequent_itemsets;
+    }
+    
+    // Level-wise parallel Apriori over the loaded transactions, reporting every
+    // level when verbose
+    map<vector<uint32_t>, int> mineApriori(bool verbose) {
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        
+        // Generate frequent 1-itemsets
+        auto frequent_k = generateFrequent1Itemsets();
+        if (verbose) cout << "Frequent 1-itemsets: " << frequent_k.size() << endl;
+        
+        // Add to all frequent itemsets
+        frequent_k.addTo(all_frequent_itemsets);
+        
+        // Working set scanned by the level loop, trimmed in place as levels progress
+        vector<vector<uint32_t>> working_transactions = transactions;
+        vector<int> working_weights = transaction_weights;
+        
+        int k = 1;
+        while (!frequent_k.empty()) {
+            if (k == 1 && pairMatrixFits(frequent_k.size())) {
+                // Level 2: count all pairs of frequent items directly instead of
+                // materializing them as candidates
+                if (verbose) {
+                    cout << "Generated " << frequent_k.size() * (frequent_k.size() - 1) / 2
+                         << " candidates for level 2 (pair matrix)" << endl;
+                }
+                
+                trimWorkingSet(frequent_k, 2, working_transactions, working_weights);
+                if (verbose) cout << "Working set for level 2: " << working_transactions.size() << " transactions" << endl;
                 
-                if (!item.empty() && item != "-1") {
-                    transaction.push_back(item);
+                frequent_k = countFrequentPairs(frequent_k, working_transactions, working_weights);
+            } else {
+                // Generate candidates for next level
+                auto candidates = generateCandidates(frequent_k);
+                if (candidates.empty()) break;
+                
+                if (verbose) cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
+                
+                trimWorkingSet(candidates, k + 1, working_transactions, working_weights);
+                if (verbose) {
+                    cout << "Working set for level " << (k+1) << ": " << working_transactions.size()
+                         << " transactions" << endl;
                 }
+                
+                // Count support in parallel
+                countSupport(candidates, working_transactions, working_weights);
+                
+                // Filter by minimum support
+                frequent_k = filterBySupport(move(candidates));
             }
             
-            if (!transaction.empty()) {
-                sort(transaction.begin(), transaction.end());
-                transactions.push_back(transaction);
-            }
+            if (verbose) cout << "Frequent " << (k+1) << "-itemsets: " << frequent_k.size() << endl;
+            
+            // Add to all frequent itemsets
+            frequent_k.addTo(all_frequent_itemsets);
+            
+            k++;
         }
         
-        file.close();
-        cout << "Loaded " << transactions.size() << " transactions" << endl;
-        return true;
+        return all_frequent_itemsets;
     }
     
-    // Parallel generation of frequent 1-itemsets
-    map<vector<string>, int> generateFrequent1Itemsets() {
-        map<string, int> item_counts;
+    // Partition (Savasere et al.): mine the text file in chunks of about budget_bytes
+    // without ever loading it whole. Pass 1 parses and mines every chunk on all
+    // threads at a threshold scaled to its share of the file; any globally frequent
+    // itemset is locally frequent in some chunk, so the union of the local results
+    // is a complete candidate set. Pass 2 reads the file once more, chunk by chunk,
+    // to count the candidates exactly. Returns false when the file is not a readable
+    // text file.
+    bool runPartition(const string& filename, size_t budget_bytes,
+                      map<vector<uint32_t>, int>& all_frequent_itemsets) {
+        auto start = high_resolution_clock::now();
         
-        // Parallel counting with reduction
-        #pragma omp parallel
-        {
-            map<string, int> local_counts;
+        cout << "\n=== Running Parallel Partition Algorithm ===" << endl;
+        cout << "Minimum support: " << min_support << endl;
+        cout << "Number of threads: " << num_threads << endl;
+        
+        struct stat file_stat;
+        if (isBinaryDatabase(filename) || stat(filename.c_str(), &file_stat) != 0) {
+            cerr << "Error: Partition mode needs a readable text file" << endl;
+            return false;
+        }
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open file " << filename << endl;
+            return false;
+        }
+        
+        // Equal chunks, so no chunk gets a tiny share and a tiny local threshold
+        size_t file_size = file_stat.st_size;
+        size_t chunk_count = max((size_t)1, (file_size + budget_bytes - 1) / max(budget_bytes, (size_t)1));
+        size_t chunk_bytes = (file_size + chunk_count - 1) / chunk_count;
+        cout << "Chunks: " << chunk_count << " of about " << chunk_bytes << " bytes" << endl << endl;
+        
+        // Pass 1: mine every chunk, with item IDs assigned in order of appearance
+        unordered_map<string, uint32_t> item_ids;
+        set<vector<uint32_t>> global_candidates;
+        string text;
+        size_t consumed = 0;
+        total_transactions = 0;
+        
+        for (int chunk_index = 1; readTextChunk(file, chunk_bytes, text); chunk_index++) {
+            ParallelApriori chunk(1, num_threads);
+            parseText(text.data(), text.size(), item_ids, chunk.transactions);
             
-            #pragma omp for
-            for (int i = 0; i < transactions.size(); i++) {
-                for (const string& item : transactions[i]) {
-                    local_counts[item]++;
-                }
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (int t = 0; t < (int)chunk.transactions.size(); t++) {
+                vector<uint32_t>& transaction = chunk.transactions[t];
+                sort(transaction.begin(), transaction.end());
+                transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
             }
             
-            // Merge local counts into global counts
-            #pragma omp critical
-            {
-                for (const auto& pair : local_counts) {
-                    item_counts[pair.first] += pair.second;
-                }
+            // ceil(s * b / B) - 1 < s * b / B, so an itemset below every local threshold
+            // has a total count below the sum of the chunk shares of s. readTextChunk may
+            // append a newline missing from the file, so the shares are clamped to file_size
+            size_t bytes = min(text.size(), file_size - consumed);
+            consumed += bytes;
+            chunk.min_support = max((size_t)1, (size_t)ceil((double)min_support * bytes / file_size));
+            chunk.total_transactions = chunk.transactions.size();
+            chunk.item_names.resize(item_ids.size());
+            chunk.collapseDuplicateTransactions();
+            total_transactions += chunk.total_transactions;
+            
+            auto local_frequent = chunk.mineApriori(false);
+            for (const auto& pair : local_frequent) {
+                global_candidates.insert(pair.first);
             }
+            cout << "Chunk " << chunk_index << ": " << chunk.total_transactions << " transactions, local support "
+                 << chunk.min_support << ", " << local_frequent.size() << " locally frequent itemsets" << endl;
         }
         
-        // Filter by minimum support
-        map<vector<string>, int> frequent_1_itemsets;
-        for (const auto& pair : item_counts) {
-            if (pair.second >= min_support) {
-                vector<string> itemset = {pair.first};
-                frequent_1_itemsets[itemset] = pair.second;
-            }
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Global candidates: " << global_candidates.size() << endl;
+        
+        // Renumber items in name order and rewrite the candidates, grouped by size
+        buildItemDictionary(item_ids);
+        vector<uint32_t> new_ids(item_ids.size());
+        for (const auto& pair : item_ids) {
+            new_ids[pair.second] = lower_bound(item_names.begin(), item_names.end(), pair.first) - item_names.begin();
         }
         
-        return frequent_1_itemsets;
-    }
-    
-    // Generate candidate itemsets from frequent k-itemsets
-    map<vector<string>, int> generateCandidates(const map<vector<string>, int>& frequent_k) {
-        map<vector<string>, int> candidates;
-        vector<vector<string>> itemsets;
+        vector<ItemsetStore> candidates_by_size;
+        for (const auto& candidate : global_candidates) {
+            vector<uint32_t> itemset;
+            for (uint32_t item : candidate) {
+                itemset.push_back(new_ids[item]);
+            }
+            sort(itemset.begin(), itemset.end());
+            while (candidates_by_size.size() <= itemset.size()) {
+                candidates_by_size.push_back(ItemsetStore(candidates_by_size.size()));
+            }
+            candidates_by_size[itemset.size()].append(itemset.data(), 0);
+        }
+        set<vector<uint32_t>>().swap(global_candidates);
         
-        // Extract itemsets
-        for (const auto& pair : frequent_k) {
-            itemsets.push_back(pair.first);
+        // One trie per itemset size, and per thread one count array per size
+        vector<CandidateTrie> tries;
+        vector<vector<int>> size_counts;
+        for (auto& candidates : candidates_by_size) {
+            candidates.sortItemsets();
+            tries.push_back(CandidateTrie(candidates));
+            size_counts.push_back(vector<int>(candidates.size(), 0));
         }
+        vector<vector<vector<int>>> thread_counts(num_threads, size_counts);
         
-        // Parallel candidate generation
-        #pragma omp parallel
-        {
-            map<vector<string>, int> local_candidates;
+        // Pass 2: read the file again chunk by chunk and count every candidate exactly
+        file.clear();
+        file.seekg(0);
+        vector<vector<uint32_t>> chunk_transactions;
+        while (readTextChunk(file, chunk_bytes, text)) {
+            chunk_transactions.clear();
+            parseText(text.data(), text.size(), item_ids, chunk_transactions);
             
-            #pragma omp for
-            for (int i = 0; i < itemsets.size(); i++) {
-                for (int j = i + 1; j < itemsets.size(); j++) {
-                    vector<string> candidate = itemsets[i];
-                    
-                    // Check if first k-1 items are the same
-                    bool can_join = true;
-                    if (candidate.size() > 0) {
-                        for (size_t k = 0; k < candidate.size() - 1; k++) {
-                            if (itemsets[i][k] != itemsets[j][k]) {
-                                can_join = false;
-                                break;
-                            }
-                        }
+            #pragma omp parallel
+            {
+                vector<vector<int>>& local_counts = thread_counts[omp_get_thread_num()];
+                
+                #pragma omp for schedule(dynamic, 256)
+                for (int t = 0; t < (int)chunk_transactions.size(); t++) {
+                    vector<uint32_t>& transaction = chunk_transactions[t];
+                    for (uint32_t& item : transaction) {
+                        item = new_ids[item];
                     }
+                    sort(transaction.begin(), transaction.end());
+                    transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
                     
-                    if (can_join) {
-                        candidate.push_back(itemsets[j].back());
-                        sort(candidate.begin(), candidate.end());
-                        local_candidates[candidate] = 0;
+                    for (size_t size = 1; size < tries.size() && transaction.size() >= size; size++) {
+                        tries[size].count(transaction, 1, local_counts[size]);
                     }
                 }
             }
-            
-            // Merge local candidates
-            #pragma omp critical
-            {
-                for (const auto& pair : local_candidates) {
-                    candidates[pair.first] = 0;
+        }
+        file.close();
+        
+        for (size_t size = 1; size < candidates_by_size.size(); size++) {
+            ItemsetStore& frequent = candidates_by_size[size];
+            for (size_t c = 0; c < frequent.size(); c++) {
+                int count = 0;
+                for (int th = 0; th < num_threads; th++) {
+                    count += thread_counts[th][size][c];
                 }
+                frequent.countData()[c] = count;
             }
+            frequent.retainAtLeast(min_support);
+            frequent.addTo(all_frequent_itemsets);
+            cout << "Frequent " << size << "-itemsets: " << frequent.size() << endl;
         }
         
-        return candidates;
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nParallel Partition completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("parallel_results.txt", ios::app);
+        result << "Parallel_Partition_" << num_threads << "_threads" << endl << duration.count() << endl;
+        result.close();
+        
+        return true;
     }
     
-    // Check if itemset is subset of transaction
-    bool isSubset(const vector<string>& itemset, const vector<string>& transaction) {
-        return includes(transaction.begin(), transaction.end(),
-                       itemset.begin(), itemset.end());
+    // Support of one bitset word: its popcount when every transaction has weight
+    // one, otherwise the summed weights of the transactions whose bits are set
+    int wordSupport(uint64_t word, size_t w) {
+        if (unit_weights) return __builtin_popcountll(word);
+        
+        int support = 0;
+        while (word) {
+            support += transaction_weights[w * 64 + __builtin_ctzll(word)];
+            word &= word - 1;
+        }
+        return support;
     }
     
-    // Parallel support counting
-    map<vector<string>, int> countSupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> support_counts;
-        
-        // Initialize support counts
-        for (const auto& pair : candidates) {
-            support_counts[pair.first] = 0;
+    // AND two transaction bitsets into out and return the support of the result
+    int intersectTidsets(const vector<uint64_t>& a, const vector<uint64_t>& b, vector<uint64_t>& out) {
+        int support = 0;
+        for (size_t w = 0; w < a.size(); w++) {
+            out[w] = a[w] & b[w];
+            support += wordSupport(out[w], w);
         }
+        return support;
+    }
+    
+    // Build the vertical layout in parallel: one bitset of transaction IDs per frequent item
+    vector<EclatMember> buildVerticalLayout() {
+        int words = (transactions.size() + 63) / 64;
+        vector<vector<uint64_t>> item_tids(item_names.size(), vector<uint64_t>(words, 0));
         
-        // Convert to vector for better parallel access
-        vector<vector<string>> candidate_list;
-        for (const auto& pair : candidates) {
-            candidate_list.push_back(pair.first);
+        // Each thread owns whole 64-transaction words, so no bit is written twice
+        #pragma omp parallel for
+        for (int w = 0; w < words; w++) {
+            size_t end = min(transactions.size(), (size_t)(w + 1) * 64);
+            for (size_t t = (size_t)w * 64; t < end; t++) {
+                for (uint32_t item : transactions[t]) {
+                    item_tids[item][w] |= 1ULL << (t % 64);
+                }
+            }
         }
         
-        // Parallel support counting
-        vector<vector<int>> thread_counts(num_threads, vector<int>(candidate_list.size(), 0));
-        
-        #pragma omp parallel
-        {
-            int thread_id = omp_get_thread_num();
-            
-            #pragma omp for
-            for (int i = 0; i < transactions.size(); i++) {
-                for (int j = 0; j < candidate_list.size(); j++) {
-                    if (isSubset(candidate_list[j], transactions[i])) {
-                        thread_counts[thread_id][j]++;
-                    }
-                }
+        vector<int> supports(item_tids.size(), 0);
+        #pragma omp parallel for
+        for (int item = 0; item < (int)item_tids.size(); item++) {
+            for (size_t w = 0; w < item_tids[item].size(); w++) {
+                supports[item] += wordSupport(item_tids[item][w], w);
             }
         }
         
-        // Aggregate results
-        for (int i = 0; i < candidate_list.size(); i++) {
-            int total_count = 0;
-            for (int t = 0; t < num_threads; t++) {
-                total_count += thread_counts[t][i];
+        vector<EclatMember> frequent_items;
+        for (uint32_t item = 0; item < item_tids.size(); item++) {
+            if (supports[item] >= min_support) {
+                EclatMember member;
+                member.item = item;
+                member.support = supports[item];
+                member.tids.swap(item_tids[item]);
+                frequent_items.push_back(member);
             }
-            support_counts[candidate_list[i]] = total_count;
         }
         
-        return support_counts;
+        return frequent_items;
     }
     
-    // Filter candidates by minimum support
-    map<vector<string>, int> filterBySupport(const map<vector<string>, int>& candidates) {
-        map<vector<string>, int> frequent;
+    // Record prefix + members[i] and mine its prefix class built from the later members
+    void extendMember(vector<uint32_t>& prefix, const vector<EclatMember>& members, size_t i,
+                      map<vector<uint32_t>, int>& results) {
+        vector<uint64_t> scratch;
+        prefix.push_back(members[i].item);
+        results[prefix] = members[i].support;
         
-        for (const auto& pair : candidates) {
-            if (pair.second >= min_support) {
-                frequent[pair.first] = pair.second;
+        vector<EclatMember> child_class;
+        for (size_t j = i + 1; j < members.size(); j++) {
+            scratch.resize(members[i].tids.size());
+            int support = intersectTidsets(members[i].tids, members[j].tids, scratch);
+            
+            if (support >= min_support) {
+                EclatMember child;
+                child.item = members[j].item;
+                child.support = support;
+                child.tids.swap(scratch);
+                child_class.push_back(child);
             }
         }
         
-        return frequent;
+        for (size_t c = 0; c < child_class.size(); c++) {
+            extendMember(prefix, child_class, c, results);
+        }
+        prefix.pop_back();
     }
     
-    // Main parallel Apriori algorithm
-    map<vector<string>, int> runApriori() {
+    // Parallel Eclat: top-level prefix classes are mined depth-first on separate threads
+    map<vector<uint32_t>, int> runEclat() {
         auto start = high_resolution_clock::now();
         
-        cout << "\n=== Running Parallel Apriori Algorithm ===" << endl;
-        cout << "Total transactions: " << transactions.size() << endl;
+        cout << "\n=== Running Parallel Eclat Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
         cout << "Minimum support: " << min_support << endl;
         cout << "Number of threads: " << num_threads << endl << endl;
         
-        map<vector<string>, int> all_frequent_itemsets;
+        auto frequent_items = buildVerticalLayout();
+        vector<map<vector<uint32_t>, int>> thread_results(num_threads);
         
-        // Generate frequent 1-itemsets
-        auto frequent_k = generateFrequent1Itemsets();
-        cout << "Frequent 1-itemsets: " << frequent_k.size() << endl;
+        #pragma omp parallel
+        {
+            int thread_id = omp_get_thread_num();
+            vector<uint32_t> prefix;
+            
+            // Early items head the largest classes, so hand them out dynamically
+            #pragma omp for schedule(dynamic)
+            for (int i = 0; i < (int)frequent_items.size(); i++) {
+                extendMember(prefix, frequent_items, i, thread_results[thread_id]);
+            }
+        }
         
-        // Add to all frequent itemsets
-        for (const auto& pair : frequent_k) {
-            all_frequent_itemsets[pair.first] = pair.second;
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        for (auto& results : thread_results) {
+            all_frequent_itemsets.insert(results.begin(), results.end());
         }
         
-        int k = 1;
-        while (!frequent_k.empty()) {
-            // Generate candidates for next level
-            auto candidates = generateCandidates(frequent_k);
-            if (candidates.empty()) break;
-            
-            cout << "Generated " << candidates.size() << " candidates for level " << (k+1) << endl;
-            
-            // Count support in parallel
-            auto support_counts = countSupport(candidates);
-            
-            // Filter by minimum support
-            frequent_k = filterBySupport(support_counts);
-            
-            cout << "Frequent " << (k+1) << "-itemsets: " << frequent_k.size() << endl;
-            
-            // Add to all frequent itemsets
-            for (const auto& pair : frequent_k) {
-                all_frequent_itemsets[pair.first] = pair.second;
+        // Report per-level totals in the same shape as the Apriori run
+        map<size_t, int> level_counts;
+        for (const auto& pair : all_frequent_itemsets) {
+            level_counts[pair.first.size()]++;
+        }
+        for (const auto& level : level_counts) {
+            cout << "Frequent " << level.first << "-itemsets: " << level.second << endl;
+        }
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "\nParallel Eclat completed!" << endl;
+        cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("parallel_results.txt", ios::app);
+        result << "Parallel_Eclat_" << num_threads << "_threads" << endl << duration.count() << endl;
+        result.close();
+        
+        return all_frequent_itemsets;
+    }
+    
+    // Parallel FP-Growth: the tree is built once, then the conditional pattern
+    // base of every header item is mined as its own OpenMP task
+    map<vector<uint32_t>, int> runFPGrowth() {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Running Parallel FP-Growth Algorithm ===" << endl;
+        cout << "Total transactions: " << total_transactions << endl;
+        cout << "Minimum support: " << min_support << endl;
+        cout << "Number of threads: " << num_threads << endl << endl;
+        
+        // First pass: frequent items, ordered by descending support
+        vector<pair<uint32_t, int>> frequent_items;
+        ItemsetStore frequent_1 = generateFrequent1Itemsets();
+        for (size_t i = 0; i < frequent_1.size(); i++) {
+            frequent_items.push_back(make_pair(frequent_1.itemset(i)[0], frequent_1.count(i)));
+        }
+        FPTree::sortBySupport(frequent_items);
+        
+        // Second pass: build the FP-tree
+        FPTree tree(min_support);
+        tree.setHeader(frequent_items);
+        for (size_t t = 0; t < transactions.size(); t++) {
+            tree.insert(transactions[t], transaction_weights[t]);
+        }
+        
+        vector<map<vector<uint32_t>, int>> thread_results(num_threads);
+        
+        #pragma omp parallel
+        {
+            #pragma omp single
+            {
+                // Least frequent items sit deepest in the tree and have the largest
+                // pattern bases, so spawn them first
+                for (size_t h = tree.headerSize(); h-- > 0;) {
+                    #pragma omp task firstprivate(h)
+                    {
+                        vector<uint32_t> suffix;
+                        tree.mineItem(h, suffix, thread_results[omp_get_thread_num()]);
+                    }
+                }
             }
-            
-            k++;
+        }
+        
+        map<vector<uint32_t>, int> all_frequent_itemsets;
+        for (auto& results : thread_results) {
+            all_frequent_itemsets.insert(results.begin(), results.end());
+        }
+        
+        // Report per-level totals in the same shape as the Apriori run
+        map<size_t, int> level_counts;
+        for (const auto& pair : all_frequent_itemsets) {
+            level_counts[pair.first.size()]++;
+        }
+        for (const auto& level : level_counts) {
+            cout << "Frequent " << level.first << "-itemsets: " << level.second << endl;
         }
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
-        cout << "\nParallel Apriori completed!" << endl;
+        cout << "\nParallel FP-Growth completed!" << endl;
         cout << "Total frequent itemsets: " << all_frequent_itemsets.size() << endl;
         cout << "Execution time: " << duration.count() << " ms" << endl;
         
         // Save timing results
         ofstream result("parallel_results.txt", ios::app);
-        result << "Parallel_" << num_threads << "_threads" << endl << duration.count() << endl;
+        result << "Parallel_FPGrowth_" << num_threads << "_threads" << endl << duration.count() << endl;
         result.close();
         
         return all_frequent_itemsets;
     }
     
-    void printResults(const map<vector<string>, int>& frequent_itemsets) {
+    void printResults(const map<vector<uint32_t>, int>& frequent_itemsets) {
         cout << "\n=== FREQUENT ITEMSETS ===" << endl;
         
         // Group by size for better readability
-        map<int, vector<pair<vector<string>, int>>> grouped_results;
+        map<int, vector<pair<vector<uint32_t>, int>>> grouped_results;
         
         for (const auto& pair : frequent_itemsets) {
             grouped_results[pair.first.size()].push_back(pair);
@@ -294,7 +1708,7 @@ public:
             for (const auto& pair : group.second) {
                 cout << "{ ";
                 for (size_t i = 0; i < pair.first.size(); i++) {
-                    cout << pair.first[i];
+                    cout << item_names[pair.first[i]];
                     if (i < pair.first.size() - 1) cout << ", ";
                 }
                 cout << " } : " << pair.second << endl;
@@ -302,6 +1716,127 @@ public:
         }
     }
     
+    // Association rules X -> Y with X u Y frequent and confidence sup(X u Y) / sup(X)
+    // of at least min_confidence. Each itemset is handled by one thread, and supports
+    // are looked up in a hash index over the frequent itemsets.
+    vector<AssociationRule> generateRules(const map<vector<uint32_t>, int>& frequent_itemsets,
+                                          double min_confidence) {
+        auto start = high_resolution_clock::now();
+        
+        cout << "\n=== Generating Association Rules ===" << endl;
+        cout << "Minimum confidence: " << min_confidence << endl;
+        
+        unordered_map<vector<uint32_t>, int, ItemsetHash> support_index(frequent_itemsets.size());
+        vector<const pair<const vector<uint32_t>, int>*> sources;
+        for (const auto& pair : frequent_itemsets) {
+            support_index.emplace(pair.first, pair.second);
+            if (pair.first.size() >= 2) sources.push_back(&pair);
+        }
+        
+        vector<vector<AssociationRule>> rules_by_source(sources.size());
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int s = 0; s < (int)sources.size(); s++) {
+            rulesFromItemset(sources[s]->first, sources[s]->second, support_index, min_confidence,
+                             rules_by_source[s]);
+        }
+        
+        vector<AssociationRule> rules;
+        for (auto& source_rules : rules_by_source) {
+            move(source_rules.begin(), source_rules.end(), back_inserter(rules));
+        }
+        
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        
+        cout << "Itemsets with rules considered: " << sources.size() << endl;
+        cout << "Total rules: " << rules.size() << endl;
+        cout << "Execution time: " << duration.count() << " ms" << endl;
+        
+        // Save timing results
+        ofstream result("parallel_results.txt", ios::app);
+        result << "Parallel_Rules_" << num_threads << "_threads" << endl << duration.count() << endl;
+        result.close();
+        
+        return rules;
+    }
+    
+    // Rules from one itemset, with consequents grown level-wise. Moving an item from
+    // the antecedent to the consequent can only lower the confidence, so only
+    // consequents whose every smaller consequent passed are tried.
+    void rulesFromItemset(const vector<uint32_t>& itemset, int support,
+                          const unordered_map<vector<uint32_t>, int, ItemsetHash>& support_index,
+                          double min_confidence, vector<AssociationRule>& rules) {
+        ItemsetStore consequents(1);
+        for (uint32_t item : itemset) {
+            consequents.append(&item, 0);
+        }
+        
+        while (!consequents.empty() && consequents.itemsetWidth() < itemset.size()) {
+            size_t width = consequents.itemsetWidth();
+            ItemsetStore passed(width);
+            for (size_t c = 0; c < consequents.size(); c++) {
+                const uint32_t* consequent = consequents.itemset(c);
+                AssociationRule rule;
+                set_difference(itemset.begin(), itemset.end(), consequent, consequent + width,
+                               back_inserter(rule.antecedent));
+                
+                rule.confidence = (double)support / support_index.at(rule.antecedent);
+                if (rule.confidence < min_confidence) continue;
+                
+                rule.consequent.assign(consequent, consequent + width);
+                rule.support = support;
+                rule.lift = rule.confidence * total_transactions / support_index.at(rule.consequent);
+                rules.push_back(rule);
+                passed.append(consequent, 0);
+            }
+            
+            consequents = joinConsequents(passed);
+        }
+    }
+    
+    // Join sorted consequents sharing all but their last item, keeping the joins whose
+    // every subset one item smaller is among them
+    ItemsetStore joinConsequents(ItemsetStore& consequents) {
+        size_t width = consequents.itemsetWidth();
+        ItemsetStore joined(width + 1);
+        consequents.buildIndex();
+        
+        vector<uint32_t> candidate(width + 1);
+        vector<uint32_t> subset(width);
+        for (size_t a = 0; a < consequents.size(); a++) {
+            size_t class_end = prefixClassEnd<0>(consequents, a);
+            copy(consequents.itemset(a), consequents.itemset(a) + width, candidate.begin());
+            
+            for (size_t b = a + 1; b < class_end; b++) {
+                candidate[width] = consequents.itemset(b)[width - 1];
+                if (hasFrequentSubsets<0>(candidate.data(), width + 1, consequents, subset.data())) {
+                    joined.append(candidate.data(), 0);
+                }
+            }
+        }
+        
+        return joined;
+    }
+    
+    void printRules(const vector<AssociationRule>& rules) {
+        cout << "\n=== ASSOCIATION RULES ===" << endl;
+        
+        for (const auto& rule : rules) {
+            cout << "{ ";
+            for (size_t i = 0; i < rule.antecedent.size(); i++) {
+                cout << item_names[rule.antecedent[i]];
+                if (i < rule.antecedent.size() - 1) cout << ", ";
+            }
+            cout << " } => { ";
+            for (size_t i = 0; i < rule.consequent.size(); i++) {
+                cout << item_names[rule.consequent[i]];
+                if (i < rule.consequent.size() - 1) cout << ", ";
+            }
+            cout << " } : support " << rule.support << ", confidence " << rule.confidence
+                 << ", lift " << rule.lift << endl;
+        }
+    }
+    
     // Performance testing with different thread counts
     void performanceTest() {
         cout << "\n=== PARALLEL PERFORMANCE TEST ===" << endl;
@@ -348,6 +1883,9 @@ int main() {
     cout << "Select mode:" << endl;
     cout << "1. Normal run" << endl;
     cout << "2. Performance test" << endl;
+    cout << "3. Eclat (vertical bitsets)" << endl;
+    cout << "4. FP-Growth" << endl;
+    cout << "5. Partition (out-of-core, two passes)" << endl;
     cin >> mode;
     
     if (min_support <= 0) {
@@ -355,17 +1893,48 @@ int main() {
         return 1;
     }
     
-    ParallelApriori apriori(min_support, num_threads);
+    size_t budget_mb = 64;
+    if (mode == 5) {
+        cout << "Enter memory budget per chunk in MB: ";
+        cin >> budget_mb;
+    }
     
-    if (!apriori.loadTransactions(filename)) {
-        return 1;
+    // Asked last, so scripted runs that stop after the mode skip rule generation
+    double min_confidence = 0;
+    if (mode != 2) {
+        cout << "Enter minimum confidence for association rules (0 skips them): ";
+        if (!(cin >> min_confidence)) min_confidence = 0;
     }
     
-    if (mode == 1) {
-        auto frequent_itemsets = apriori.runApriori();
-        apriori.printResults(frequent_itemsets);
+    ParallelApriori apriori(min_support, num_threads);
+    map<vector<uint32_t>, int> frequent_itemsets;
+    
+    // Partition mode streams the file itself instead of loading it
+    if (mode == 5) {
+        if (!apriori.runPartition(filename, max(budget_mb, (size_t)1) << 20, frequent_itemsets)) {
+            return 1;
+        }
     } else {
-        apriori.performanceTest();
+        if (!apriori.loadTransactions(filename)) {
+            return 1;
+        }
+        
+        if (mode == 1) {
+            frequent_itemsets = apriori.runApriori();
+        } else if (mode == 3) {
+            frequent_itemsets = apriori.runEclat();
+        } else if (mode == 4) {
+            frequent_itemsets = apriori.runFPGrowth();
+        } else {
+            apriori.performanceTest();
+            return 0;
+        }
+    }
+    apriori.printResults(frequent_itemsets);
+    
+    if (min_confidence > 0) {
+        auto rules = apriori.generateRules(frequent_itemsets, min_confidence);
+        apriori.printRules(rules);
     }
     
     return 0;
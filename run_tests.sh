@@ -5,7 +5,8 @@ echo "=== Enhanced Apriori Algorithm Performance Testing ==="
 echo "Compiling programs..."
 g++ -o sequential aprioriomp.cpp -std=c++11 -O2
 g++ -o parallel recursiveparallel.cpp -fopenmp -std=c++11 -O2
-mpic++ -o distributed distributed.cpp -std=c++11 -O2
+mpic++ -o distributed distributed.cpp -fopenmp -std=c++11 -O2
+g++ -o convert convert.cpp -std=c++11 -O2
 
 echo "Creating test datasets..."
 
@@ -69,7 +70,55 @@ run_performance_test() {
     
     # Test Sequential Version
     echo "Testing Sequential Version..."
-    echo -e "$dataset\n$min_support" | timeout 60s ./sequential > sequential_${dataset%.*}_output.txt 2>&1
+    echo -e "$dataset\n$min_support\n1" | timeout 60s ./sequential > sequential_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Eclat mode
+    echo "Testing Sequential Eclat..."
+    echo -e "$dataset\n$min_support\n2" | timeout 60s ./sequential > sequential_eclat_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential FP-Growth mode
+    echo "Testing Sequential FP-Growth..."
+    echo -e "$dataset\n$min_support\n3" | timeout 60s ./sequential > sequential_fpgrowth_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Partition mode with a 1 MB chunk budget
+    echo "Testing Sequential Partition..."
+    echo -e "$dataset\n$min_support\n4\n1" | timeout 60s ./sequential > sequential_partition_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Sampling mode with a 10% sample
+    echo "Testing Sequential Sampling..."
+    echo -e "$dataset\n$min_support\n6\n10" | timeout 60s ./sequential > sequential_sampling_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Closed (CHARM) mode, with and without deriving all frequent itemsets
+    echo "Testing Sequential Closed (CHARM)..."
+    echo -e "$dataset\n$min_support\n7\n0" | timeout 60s ./sequential > sequential_closed_${dataset%.*}_output.txt 2>&1
+    echo -e "$dataset\n$min_support\n7\n1" | timeout 60s ./sequential > sequential_closed_expanded_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Maximal (GenMax) mode
+    echo "Testing Sequential Maximal (GenMax)..."
+    echo -e "$dataset\n$min_support\n8" | timeout 60s ./sequential > sequential_maximal_${dataset%.*}_output.txt 2>&1
+    
+    # Test Sequential Incremental (FUP) mode: mine the first half of the dataset,
+    # append the rest, mine again and compare with the full Apriori run
+    echo "Testing Sequential Incremental (FUP)..."
+    local incremental_file="incremental_${dataset}"
+    local line_count=$(wc -l < "$dataset")
+    rm -f "$incremental_file" "${incremental_file}.state"
+    head -n $((line_count / 2)) "$dataset" > "$incremental_file"
+    echo -e "$incremental_file\n$min_support\n5" | timeout 60s ./sequential > /dev/null 2>&1
+    tail -n +$((line_count / 2 + 1)) "$dataset" >> "$incremental_file"
+    echo -e "$incremental_file\n$min_support\n5" | timeout 60s ./sequential > sequential_incremental_${dataset%.*}_output.txt 2>&1
+    if diff <(grep '^{' sequential_incremental_${dataset%.*}_output.txt | sort) \
+            <(grep '^{' sequential_${dataset%.*}_output.txt | sort) > /dev/null; then
+        echo "  Incremental result matches the full run"
+    else
+        echo "  Incremental result DIFFERS from the full run"
+    fi
+    rm -f "$incremental_file" "${incremental_file}.state"
+    
+    # Test Sequential Version on the binary database
+    echo "Testing Sequential Version (binary input)..."
+    echo -e "$dataset\n${dataset}.bin" | ./convert > /dev/null 2>&1
+    echo -e "${dataset}.bin\n$min_support\n1" | timeout 60s ./sequential > sequential_binary_${dataset%.*}_output.txt 2>&1
     
     # Test Parallel Version with different thread counts
     echo "Testing Parallel Version..."
@@ -77,6 +126,8 @@ run_performance_test() {
         if [ $threads -le $max_threads ]; then
             echo "  Testing with $threads threads..."
             echo -e "$dataset\n$min_support\n$threads\n1" | timeout 60s ./parallel > parallel_${threads}_${dataset%.*}_output.txt 2>&1
+            echo -e "$dataset\n$min_support\n$threads\n5\n1" | timeout 60s ./parallel > parallel_partition_${threads}_${dataset%.*}_output.txt 2>&1
+            echo -e "$dataset\n$min_support\n$threads\n1\n0.5" | timeout 60s ./parallel > parallel_rules_${threads}_${dataset%.*}_output.txt 2>&1
         fi
     done
     
@@ -85,7 +136,11 @@ run_performance_test() {
     for procs in 1 2 4 8; do
         if [ $procs -le $max_threads ]; then
             echo "  Testing with $procs processes..."
-            echo -e "$min_support\n$dataset\n1" | timeout 60s mpirun -np $procs ./distributed > distributed_${procs}_${dataset%.*}_output.txt 2>&1
+            echo -e "$min_support\n$dataset\n1" | OMP_NUM_THREADS=1 timeout 60s mpirun -x OMP_NUM_THREADS -np $procs ./distributed > distributed_${procs}_${dataset%.*}_output.txt 2>&1
+            echo -e "$min_support\n$dataset\n4\n0" | OMP_NUM_THREADS=1 timeout 60s mpirun -x OMP_NUM_THREADS -np $procs ./distributed > distributed_candidate_${procs}_${dataset%.*}_output.txt 2>&1
+            
+            # Hybrid layout: one process using the same number of cores as threads
+            echo -e "$min_support\n$dataset\n1" | OMP_NUM_THREADS=$procs timeout 60s mpirun -x OMP_NUM_THREADS -np 1 ./distributed > distributed_hybrid_${procs}_${dataset%.*}_output.txt 2>&1
         fi
     done
     
@@ -120,6 +175,18 @@ def extract_timing(filename):
         pass
     return None
 
+def extract_rule_timing(filename):
+    try:
+        with open(filename, 'r') as f:
+            content = f.read()
+            # The rule generation time follows the rule count
+            match = re.search(r'Total rules: \d+\s*\nExecution time: (\d+) ms', content)
+            if match:
+                return int(match.group(1))
+    except FileNotFoundError:
+        pass
+    return None
+
 def analyze_results():
     datasets = ['small_data', 'medium_data', 'large_data']
     
@@ -135,6 +202,42 @@ def analyze_results():
         if seq_time is not None:
             print(f"Sequential: {seq_time} ms")
         
+        eclat_time = extract_timing(f'sequential_eclat_{dataset}_output.txt')
+        if eclat_time is not None:
+            print(f"Sequential Eclat: {eclat_time} ms")
+        
+        fpgrowth_time = extract_timing(f'sequential_fpgrowth_{dataset}_output.txt')
+        if fpgrowth_time is not None:
+            print(f"Sequential FP-Growth: {fpgrowth_time} ms")
+        
+        partition_time = extract_timing(f'sequential_partition_{dataset}_output.txt')
+        if partition_time is not None:
+            print(f"Sequential Partition: {partition_time} ms")
+        
+        sampling_time = extract_timing(f'sequential_sampling_{dataset}_output.txt')
+        if sampling_time is not None:
+            print(f"Sequential Sampling: {sampling_time} ms")
+        
+        closed_time = extract_timing(f'sequential_closed_{dataset}_output.txt')
+        if closed_time is not None:
+            print(f"Sequential Closed (CHARM): {closed_time} ms")
+        
+        closed_expanded_time = extract_timing(f'sequential_closed_expanded_{dataset}_output.txt')
+        if closed_expanded_time is not None:
+            print(f"Sequential Closed (CHARM, expanded): {closed_expanded_time} ms")
+        
+        maximal_time = extract_timing(f'sequential_maximal_{dataset}_output.txt')
+        if maximal_time is not None:
+            print(f"Sequential Maximal (GenMax): {maximal_time} ms")
+        
+        incremental_time = extract_timing(f'sequential_incremental_{dataset}_output.txt')
+        if incremental_time is not None:
+            print(f"Sequential Incremental (FUP, appended half): {incremental_time} ms")
+        
+        binary_time = extract_timing(f'sequential_binary_{dataset}_output.txt')
+        if binary_time is not None:
+            print(f"Sequential (binary input): {binary_time} ms")
+        
         # Parallel
         print("Parallel (threads -> time):")
         for threads in [1, 2, 4, 8, 16]:
@@ -143,6 +246,18 @@ def analyze_results():
                 speedup = seq_time / par_time if seq_time and par_time > 0 else 0
                 print(f"  {threads} threads: {par_time} ms (speedup: {speedup:.2f}x)")
         
+        print("Parallel Partition (threads -> time):")
+        for threads in [1, 2, 4, 8, 16]:
+            partition_time = extract_timing(f'parallel_partition_{threads}_{dataset}_output.txt')
+            if partition_time is not None:
+                print(f"  {threads} threads: {partition_time} ms")
+        
+        print("Parallel rule generation, confidence 0.5 (threads -> time):")
+        for threads in [1, 2, 4, 8, 16]:
+            rules_time = extract_rule_timing(f'parallel_rules_{threads}_{dataset}_output.txt')
+            if rules_time is not None:
+                print(f"  {threads} threads: {rules_time} ms")
+        
         # Distributed
         print("Distributed (processes -> time):")
         for procs in [1, 2, 4, 8]:
@@ -150,6 +265,20 @@ def analyze_results():
             if dist_time is not None:
                 speedup = seq_time / dist_time if seq_time and dist_time > 0 else 0
                 print(f"  {procs} processes: {dist_time} ms (speedup: {speedup:.2f}x)")
+        
+        print("Distributed candidate distribution (processes -> time):")
+        for procs in [1, 2, 4, 8]:
+            candidate_time = extract_timing(f'distributed_candidate_{procs}_{dataset}_output.txt')
+            if candidate_time is not None:
+                speedup = seq_time / candidate_time if seq_time and candidate_time > 0 else 0
+                print(f"  {procs} processes: {candidate_time} ms (speedup: {speedup:.2f}x)")
+        
+        print("Distributed hybrid (1 process, threads -> time):")
+        for threads in [1, 2, 4, 8]:
+            hybrid_time = extract_timing(f'distributed_hybrid_{threads}_{dataset}_output.txt')
+            if hybrid_time is not None:
+                speedup = seq_time / hybrid_time if seq_time and hybrid_time > 0 else 0
+                print(f"  {threads} threads: {hybrid_time} ms (speedup: {speedup:.2f}x)")
 
 if __name__ == "__main__":
     analyze_results()